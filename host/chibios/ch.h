@@ -0,0 +1,29 @@
+#ifndef CH_H
+#define CH_H
+
+// ChibiOS Host Shim ----------------------------------------------------------------------------------------------------------
+//
+// Author: agent
+// Date Created: 2026.10.17
+//
+// Description: See hal.h. As there is a single thread, mutexes have no effect.
+
+#include "hal.h"
+
+// Datatypes ------------------------------------------------------------------------------------------------------------------
+
+typedef struct
+{
+	/// @brief Indicates the mutex is locked. Only used for catching unbalanced lock / unlock calls.
+	bool locked;
+} mutex_t;
+
+// Mutexes --------------------------------------------------------------------------------------------------------------------
+
+void chMtxObjectInit (mutex_t* mutex);
+
+void chMtxLock (mutex_t* mutex);
+
+void chMtxUnlock (mutex_t* mutex);
+
+#endif // CH_H
\ No newline at end of file
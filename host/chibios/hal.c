@@ -0,0 +1,169 @@
+// Header
+#include "hal.h"
+#include "ch.h"
+
+// C Standard Library
+#include <assert.h>
+
+// Constants ------------------------------------------------------------------------------------------------------------------
+
+/// @brief The clock frequency of a bus started without a configuration, in Hz.
+#define I2C_DEFAULT_CLOCK_SPEED 400000
+
+/// @brief Number of clock cycles per byte on the bus (8 data bits and an acknowledge bit).
+#define I2C_CYCLES_PER_BYTE 9
+
+// Global Variables -----------------------------------------------------------------------------------------------------------
+
+static systime_t systemTime = 0;
+
+// Function Prototypes --------------------------------------------------------------------------------------------------------
+
+sysinterval_t i2cTransferTime (I2CDriver* i2c, size_t byteCount);
+
+// Virtual Clock --------------------------------------------------------------------------------------------------------------
+
+systime_t chVTGetSystemTime (void)
+{
+	return systemTime;
+}
+
+systime_t chVTGetSystemTimeX (void)
+{
+	return systemTime;
+}
+
+sysinterval_t chTimeDiffX (systime_t start, systime_t end)
+{
+	return (sysinterval_t) (end - start);
+}
+
+void hostClockAdvance (sysinterval_t interval)
+{
+	systemTime += interval;
+}
+
+void chThdSleep (sysinterval_t interval)
+{
+	hostClockAdvance (interval);
+}
+
+void chThdSleepMilliseconds (uint32_t milliseconds)
+{
+	hostClockAdvance (TIME_MS2I (milliseconds));
+}
+
+void chThdYield (void)
+{
+	// Single thread, nothing to yield to.
+}
+
+void chSysLock (void)
+{
+	// Single thread, nothing to lock against.
+}
+
+void chSysUnlock (void)
+{
+}
+
+syssts_t osalSysGetStatusAndLockX (void)
+{
+	// No interrupts, the status is always unlocked.
+	return 0;
+}
+
+void osalSysRestoreStatusX (syssts_t sts)
+{
+	(void) sts;
+}
+
+// Mutexes --------------------------------------------------------------------------------------------------------------------
+
+void chMtxObjectInit (mutex_t* mutex)
+{
+	mutex->locked = false;
+}
+
+void chMtxLock (mutex_t* mutex)
+{
+	// With a single thread, locking a locked mutex would deadlock.
+	assert (!mutex->locked);
+	mutex->locked = true;
+}
+
+void chMtxUnlock (mutex_t* mutex)
+{
+	assert (mutex->locked);
+	mutex->locked = false;
+}
+
+// I2C Driver -----------------------------------------------------------------------------------------------------------------
+
+void i2cStart (I2CDriver* i2c, const I2CConfig* config)
+{
+	i2c->config = config;
+}
+
+void i2cStop (I2CDriver* i2c)
+{
+	i2c->config = NULL;
+}
+
+void i2cAcquireBus (I2CDriver* i2c)
+{
+	(void) i2c;
+}
+
+void i2cReleaseBus (I2CDriver* i2c)
+{
+	(void) i2c;
+}
+
+msg_t i2cMasterTransmitTimeout (I2CDriver* i2c, i2caddr_t addr, const uint8_t* tx, size_t txCount, uint8_t* rx,
+	size_t rxCount, sysinterval_t timeout)
+{
+	(void) timeout;
+
+	if (i2c->transfer == NULL)
+	{
+		// Nothing on the bus, the address byte is not acknowledged.
+		hostClockAdvance (i2cTransferTime (i2c, 1));
+		return MSG_RESET;
+	}
+
+	msg_t result = i2c->transfer (i2c->device, addr, tx, txCount, rx, rxCount);
+
+	// A failed transfer is aborted after the address byte. Otherwise each direction is preceded by an address byte.
+	if (result != MSG_OK)
+		hostClockAdvance (i2cTransferTime (i2c, 1));
+	else
+		hostClockAdvance (i2cTransferTime (i2c, (txCount > 0) + txCount + (rxCount > 0) + rxCount));
+
+	return result;
+}
+
+/// @brief Calculates the duration of a transfer of the specified number of bytes.
+sysinterval_t i2cTransferTime (I2CDriver* i2c, size_t byteCount)
+{
+	uint32_t clockSpeed = I2C_DEFAULT_CLOCK_SPEED;
+	if (i2c->config != NULL && i2c->config->clock_speed != 0)
+		clockSpeed = i2c->config->clock_speed;
+
+	uint64_t cycles = (uint64_t) byteCount * I2C_CYCLES_PER_BYTE;
+	return (sysinterval_t) ((cycles * CH_CFG_ST_FREQUENCY + clockSpeed - 1) / clockSpeed);
+}
+
+// CAN Driver -----------------------------------------------------------------------------------------------------------------
+
+msg_t canTransmitTimeout (CANDriver* can, canmbx_t mailbox, const CANTxFrame* frame, sysinterval_t timeout)
+{
+	(void) mailbox;
+	(void) timeout;
+
+	// Nothing on the bus to acknowledge the frame.
+	if (can->transmit == NULL)
+		return MSG_TIMEOUT;
+
+	return can->transmit (can->bus, frame);
+}
\ No newline at end of file
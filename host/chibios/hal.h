@@ -0,0 +1,209 @@
+#ifndef HAL_H
+#define HAL_H
+
+// ChibiOS Host Shim ----------------------------------------------------------------------------------------------------------
+//
+// Author: agent
+// Date Created: 2026.10.17
+//
+// Description: Minimal stand-in for the ChibiOS HAL / RT APIs used by the library, allowing modules to be built and run on a
+//   Linux host. Time is simulated by a virtual clock with a 1 us tick, which only advances when a thread sleeps or when a
+//   bus transfer is performed, making runs deterministic and independent of the host's speed. There is a single thread,
+//   so locks and yields have no effect.
+//
+//   I2C transfers are dispatched to a simulated device attached to the driver (see host/peripherals/). CAN transmissions are
+//   dispatched to a handler attached to the driver, which is responsible for simulating the bus. The ADC driver only
+//   provides the types needed by the analog module's users, sensors being updated with samples directly.
+
+// C Standard Library
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Constants ------------------------------------------------------------------------------------------------------------------
+
+#define MSG_OK		((msg_t) 0)
+#define MSG_TIMEOUT	((msg_t) -1)
+#define MSG_RESET	((msg_t) -2)
+
+/// @brief Frequency of the virtual clock's tick, in Hz.
+#define CH_CFG_ST_FREQUENCY 1000000
+
+#define TIME_US2I(us) ((sysinterval_t) (us))
+#define TIME_MS2I(ms) ((sysinterval_t) ((ms) * 1000))
+#define TIME_S2I(s) ((sysinterval_t) ((s) * 1000000))
+#define TIME_I2US(interval) ((uint32_t) (interval))
+#define TIME_I2MS(interval) ((uint32_t) ((interval) / 1000))
+
+// No ADC peripherals or timers, only the types of the ADC driver are provided.
+#define HAL_USE_GPT			0
+#define STM32_ADC_USE_ADC1	0
+#define STM32_ADC_USE_ADC2	0
+#define STM32_ADC_USE_ADC3	0
+
+// Datatypes ------------------------------------------------------------------------------------------------------------------
+
+typedef int32_t msg_t;
+typedef uint32_t syssts_t;
+typedef uint16_t adcsample_t;
+typedef uint16_t adc_channels_num_t;
+typedef uint32_t systime_t;
+typedef uint32_t sysinterval_t;
+typedef uint16_t i2caddr_t;
+
+typedef struct
+{
+	/// @brief The clock frequency of the bus, in Hz. Determines the simulated duration of each transfer.
+	uint32_t clock_speed;
+} I2CConfig;
+
+/**
+ * @brief Function performing a transfer with a simulated I2C device.
+ * @param device The device to transfer with.
+ * @param addr The 7-bit address the transfer is directed to.
+ * @param tx The data to transmit.
+ * @param txCount The number of bytes to transmit.
+ * @param rx The buffer to receive into.
+ * @param rxCount The number of bytes to receive.
+ * @return @c MSG_OK if the device acknowledged the transfer, @c MSG_RESET otherwise.
+ */
+typedef msg_t (*hostI2cTransfer_t) (void* device, i2caddr_t addr, const uint8_t* tx, size_t txCount, uint8_t* rx,
+	size_t rxCount);
+
+typedef uint32_t canmbx_t;
+
+#define CAN_ANY_MAILBOX 0
+
+#define CAN_IDE_STD 0
+#define CAN_IDE_EXT 1
+
+typedef struct
+{
+	uint8_t DLC : 4;
+	uint8_t RTR : 1;
+	uint8_t IDE : 1;
+	union
+	{
+		uint32_t SID : 11;
+		uint32_t EID : 29;
+	};
+	union
+	{
+		uint8_t data8 [8];
+		uint16_t data16 [4];
+		uint32_t data32 [2];
+	};
+} CANTxFrame;
+
+typedef struct
+{
+	uint8_t FMI;
+	uint16_t TIME;
+	uint8_t DLC : 4;
+	uint8_t RTR : 1;
+	uint8_t IDE : 1;
+	union
+	{
+		uint32_t SID : 11;
+		uint32_t EID : 29;
+	};
+	union
+	{
+		uint8_t data8 [8];
+		uint16_t data16 [4];
+		uint32_t data32 [2];
+	};
+} CANRxFrame;
+
+/**
+ * @brief Function handling a frame transmitted by a CAN driver.
+ * @param bus The bus the driver is attached to.
+ * @param frame The transmitted frame.
+ * @return @c MSG_OK if the frame was transmitted, @c MSG_TIMEOUT otherwise.
+ */
+typedef msg_t (*hostCanTransmit_t) (void* bus, const CANTxFrame* frame);
+
+typedef struct
+{
+	/// @brief The transmit handler of the bus the driver is attached to.
+	hostCanTransmit_t transmit;
+
+	/// @brief The bus the driver is attached to.
+	void* bus;
+} CANDriver;
+
+typedef struct
+{
+	/// @brief The configuration the driver was started with, @c NULL if stopped.
+	const I2CConfig* config;
+
+	/// @brief The transfer function of the device attached to the bus.
+	hostI2cTransfer_t transfer;
+
+	/// @brief The device attached to the bus.
+	void* device;
+} I2CDriver;
+
+typedef struct
+{
+	/// @brief The number of channels in the sequence.
+	adc_channels_num_t num_channels;
+} ADCConversionGroup;
+
+typedef struct
+{
+	/// @brief The group being converted, @c NULL if idle.
+	const ADCConversionGroup* grpp;
+} ADCDriver;
+
+// Virtual Clock --------------------------------------------------------------------------------------------------------------
+
+systime_t chVTGetSystemTime (void);
+
+systime_t chVTGetSystemTimeX (void);
+
+sysinterval_t chTimeDiffX (systime_t start, systime_t end);
+
+/**
+ * @brief Advances the virtual clock.
+ * @param interval The interval to advance by, in ticks.
+ */
+void hostClockAdvance (sysinterval_t interval);
+
+void chThdSleep (sysinterval_t interval);
+
+void chThdSleepMilliseconds (uint32_t milliseconds);
+
+void chThdYield (void);
+
+void chSysLock (void);
+
+void chSysUnlock (void);
+
+#define osalSysLock()			chSysLock ()
+#define osalSysUnlock()			chSysUnlock ()
+#define osalSysLockFromISR()	chSysLock ()
+#define osalSysUnlockFromISR()	chSysUnlock ()
+
+syssts_t osalSysGetStatusAndLockX (void);
+
+void osalSysRestoreStatusX (syssts_t sts);
+
+// I2C Driver -----------------------------------------------------------------------------------------------------------------
+
+void i2cStart (I2CDriver* i2c, const I2CConfig* config);
+
+void i2cStop (I2CDriver* i2c);
+
+void i2cAcquireBus (I2CDriver* i2c);
+
+void i2cReleaseBus (I2CDriver* i2c);
+
+msg_t i2cMasterTransmitTimeout (I2CDriver* i2c, i2caddr_t addr, const uint8_t* tx, size_t txCount, uint8_t* rx,
+	size_t rxCount, sysinterval_t timeout);
+
+// CAN Driver -----------------------------------------------------------------------------------------------------------------
+
+msg_t canTransmitTimeout (CANDriver* can, canmbx_t mailbox, const CANTxFrame* frame, sysinterval_t timeout);
+
+#endif // HAL_H
\ No newline at end of file
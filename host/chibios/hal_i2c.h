@@ -0,0 +1,13 @@
+#ifndef HAL_I2C_H
+#define HAL_I2C_H
+
+// ChibiOS Host Shim ----------------------------------------------------------------------------------------------------------
+//
+// Author: agent
+// Date Created: 2026.10.17
+//
+// Description: See hal.h, the I2C driver is declared there.
+
+#include "hal.h"
+
+#endif // HAL_I2C_H
\ No newline at end of file
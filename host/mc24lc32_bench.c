@@ -0,0 +1,536 @@
+// MC24LC32 Benchmark ---------------------------------------------------------------------------------------------------------
+//
+// Author: agent
+// Date Created: 2026.10.17
+//
+// Description: Runs the mc24lc32 driver against the simulated device, reporting the cost (page writes and bus time) of
+//   typical operations, checks write-throughs land at the correct addresses (reading back the device's memory), checks the
+//   migration of legacy images, then sweeps a power loss across every page write of a commit,
+//   checking the memory is recovered as either entirely the old or entirely the new contents. Lastly, simulates a long run
+//   of journal updates with periodic power losses, reporting the journal's write cost and wear distribution, and checking no
+//   update other than an interrupted one is lost. The parameter schema's accessors and migration, the lazy checks of the
+//   region CRCs, and the persistence of a linear sensor's calibration are checked against the simulated device as well.
+//
+// Usage: mc24lc32_bench [seeds per power loss point] [journal updates]
+
+// Includes
+#include "peripherals/linear_sensor_calibration.h"
+#include "peripherals/mc24lc32.h"
+#include "peripherals/mc24lc32_journal.h"
+#include "peripherals/mc24lc32_schema.h"
+#include "peripherals/mc24lc32_sim.h"
+
+// C Standard Library
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Constants ------------------------------------------------------------------------------------------------------------------
+
+#define DEVICE_ADDRESS 0x50
+
+#define MAGIC_STRING "mc24lc32_bench"
+
+/// @brief Section of the cache modified by the power loss sweep. Spans multiple pages and regions.
+#define SWEEP_ADDRESS 200
+#define SWEEP_COUNT 100
+
+/// @brief Address of the linear sensor's calibration record.
+#define CALIBRATION_ADDRESS 0x0300
+
+/// @brief Number of keys updated by the journal simulation.
+#define JOURNAL_KEY_COUNT 8
+
+/// @brief Number of journal updates between each power loss.
+#define JOURNAL_POWER_LOSS_PERIOD 1000
+
+// Parameter Schema -----------------------------------------------------------------------------------------------------------
+
+/// @brief Address of the schema's layout version.
+#define SCHEMA_VERSION_ADDRESS 0x0010
+
+/// @brief Parameters of the schema, PedalDeadzone being introduced in version 2.
+#define SCHEMA_PARAMETERS(X, p)																						\
+	X (p, TorqueLimit,		float,		0x0020,	21.0f,	0.0f,	21.0f,	1)											\
+	X (p, RegenEnabled,		uint8_t,	0x0024,	1,		0,		1,		1)											\
+	X (p, PedalDeadzone,	float,		0x0028,	0.05f,	0.0f,	0.25f,	2)
+
+MC24LC32_SCHEMA_DECLARE (schema, SCHEMA_PARAMETERS)
+
+MC24LC32_SCHEMA_DEFINE (schema, SCHEMA_PARAMETERS, SCHEMA_VERSION_ADDRESS, 2)
+
+// Global Variables -----------------------------------------------------------------------------------------------------------
+
+static I2CDriver i2c;
+
+static const I2CConfig i2cConfig =
+{
+	.clock_speed = 400000
+};
+
+static mc24lc32Sim_t sim;
+
+static mc24lc32_t eeprom;
+
+static mc24lc32Config_t eepromConfig =
+{
+	.addr			= DEVICE_ADDRESS,
+	.i2c			= &i2c,
+	.timeoutPeriod	= TIME_MS2I (100),
+	.magicString	= MAGIC_STRING
+};
+
+static mc24lc32Journal_t journal;
+
+static mc24lc32JournalConfig_t journalConfig =
+{
+	.eeprom		= &eeprom,
+	.keyCount	= JOURNAL_KEY_COUNT,
+	.defaults	= NULL
+};
+
+// Function Prototypes --------------------------------------------------------------------------------------------------------
+
+void benchmarkBegin (void);
+
+void benchmarkEnd (const char* name, bool result);
+
+void sweepFill (uint8_t value);
+
+int sweepCheck (uint8_t oldValue, uint8_t newValue);
+
+uint32_t journalRandom (void);
+
+uint32_t journalSimulate (uint32_t updateCount);
+
+void schemaStoreVersion (uint16_t version);
+
+bool writeThroughCheck (uint16_t address, uint16_t count);
+
+// Scenarios ------------------------------------------------------------------------------------------------------------------
+
+static systime_t benchmarkStart;
+
+/// @brief The number of operations that failed.
+static uint32_t benchmarkFailureCount = 0;
+
+void benchmarkBegin (void)
+{
+	mc24lc32SimResetStatistics (&sim);
+	benchmarkStart = chVTGetSystemTime ();
+}
+
+void benchmarkEnd (const char* name, bool result)
+{
+	sysinterval_t duration = chTimeDiffX (benchmarkStart, chVTGetSystemTime ());
+	if (!result)
+		++benchmarkFailureCount;
+
+	printf ("%-40s %-4s %4u page writes, %6u bytes read, %4u NACKs, %8.3f ms\n", name, result ? "ok" : "FAIL",
+		sim.pageWriteCount, sim.readByteCount, sim.nackCount, TIME_I2US (duration) / 1000.0);
+}
+
+/// @brief Fills the swept section of the cache with a value, marking it as dirty.
+void sweepFill (uint8_t value)
+{
+	memset (eeprom.cache + SWEEP_ADDRESS, value, SWEEP_COUNT);
+	mc24lc32MarkDirty (&eeprom, SWEEP_ADDRESS, SWEEP_COUNT);
+}
+
+/// @brief Checks the swept section of the cache is valid and entirely one of the values.
+/// @return 0 if old, 1 if new, -1 if neither.
+int sweepCheck (uint8_t oldValue, uint8_t newValue)
+{
+	if (!mc24lc32IsValid (&eeprom) || !mc24lc32IsRegionValid (&eeprom, 0, MC24LC32_DATA_SIZE))
+		return -1;
+
+	int result = eeprom.cache [SWEEP_ADDRESS] == oldValue ? 0 : eeprom.cache [SWEEP_ADDRESS] == newValue ? 1 : -1;
+	for (uint16_t index = 1; index < SWEEP_COUNT; ++index)
+		if (eeprom.cache [SWEEP_ADDRESS + index] != eeprom.cache [SWEEP_ADDRESS])
+			return -1;
+
+	return result;
+}
+
+/// @brief Generates a pseudo-random number (xorshift32) for the journal simulation.
+uint32_t journalRandom (void)
+{
+	static uint32_t seed = 0x2545F491;
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+/// @brief Performs a number of journal updates, losing power during every @c JOURNAL_POWER_LOSS_PERIOD th update, after
+/// which the journal is recovered and checked against the expected values.
+/// @return The number of keys that were not recovered correctly.
+uint32_t journalSimulate (uint32_t updateCount)
+{
+	uint32_t expected [JOURNAL_KEY_COUNT] = { 0 };
+	uint32_t powerLossCount = 0;
+	uint32_t lostCount = 0;
+	uint32_t failureCount = 0;
+
+	if (!mc24lc32JournalInit (&journal, &journalConfig))
+		return 1;
+
+	mc24lc32SimResetStatistics (&sim);
+	for (uint32_t update = 0; update < updateCount; ++update)
+	{
+		// Lower keys are updated more frequently than higher keys.
+		uint8_t key = journalRandom () % (journalRandom () % JOURNAL_KEY_COUNT + 1);
+		uint32_t value = update + 1;
+
+		// Lose power during either the first or the second page write of the update (if it has one).
+		bool powerLoss = update % JOURNAL_POWER_LOSS_PERIOD == JOURNAL_POWER_LOSS_PERIOD - 1;
+		if (powerLoss)
+			mc24lc32SimSchedulePowerLoss (&sim, journalRandom () % 2, journalRandom ());
+
+		// Note an update is only complete if the power outlasted the write cycle of its last page write.
+		bool completed = mc24lc32JournalWrite (&journal, key, value) && sim.powered;
+		if (completed)
+			expected [key] = value;
+
+		if (!powerLoss)
+			continue;
+
+		// Recover the journal, as if after a reset. The interrupted update may or may not have been written.
+		++powerLossCount;
+		mc24lc32SimPowerCycle (&sim);
+		mc24lc32Init (&eeprom, &eepromConfig);
+		if (!mc24lc32JournalInit (&journal, &journalConfig))
+			return failureCount + 1;
+
+		for (uint8_t checkKey = 0; checkKey < JOURNAL_KEY_COUNT; ++checkKey)
+		{
+			uint32_t actual = mc24lc32JournalRead (&journal, checkKey);
+			if (checkKey == key && !completed && actual == value)
+				expected [key] = value;
+			else if (checkKey == key && !completed && actual == expected [key])
+				++lostCount;
+			else if (actual != expected [checkKey])
+				++failureCount;
+		}
+	}
+
+	// Wear of the journal area's pages.
+	uint32_t wearMin = UINT32_MAX;
+	uint32_t wearMax = 0;
+	for (uint16_t page = MC24LC32_JOURNAL_ADDRESS / MC24LC32_PAGE_SIZE; page < MC24LC32_SIM_PAGE_COUNT; ++page)
+	{
+		if (sim.pageWriteCounts [page] < wearMin)
+			wearMin = sim.pageWriteCounts [page];
+		if (sim.pageWriteCounts [page] > wearMax)
+			wearMax = sim.pageWriteCounts [page];
+	}
+
+	printf ("  %u updates, %.4f page writes per update, %u to %u page writes per journal page\n", updateCount,
+		(double) sim.pageWriteCount / updateCount, wearMin, wearMax);
+	printf ("  %u power losses, %u interrupted updates lost, %u keys corrupt\n", powerLossCount, lostCount, failureCount);
+
+	return failureCount;
+}
+
+/// @brief The expected contents of the cache / active bank, maintained independently of the driver.
+static uint8_t writeThroughExpected [MC24LC32_DATA_SIZE];
+
+/// @brief Writes a pattern through to the device, then checks the device's active bank (in the simulated memory) matches
+/// the expected contents, and that re-reading the device from scratch yields the same contents.
+bool writeThroughCheck (uint16_t address, uint16_t count)
+{
+	uint8_t data [MC24LC32_DATA_SIZE];
+	for (uint16_t index = 0; index < count; ++index)
+		data [index] = (uint8_t) (address * 7 + index * 13 + 1);
+
+	memcpy (writeThroughExpected + address, data, count);
+	if (!mc24lc32WriteThrough (&eeprom, address, data, count))
+		return false;
+
+	// Every byte of the active bank must match, meaning nothing was written to the wrong address.
+	if (memcmp (sim.memory + eeprom.activeBank * MC24LC32_BANK_SIZE, writeThroughExpected, MC24LC32_DATA_SIZE) != 0)
+		return false;
+
+	memset (eeprom.cache, 0, sizeof (eeprom.cache));
+	return mc24lc32Read (&eeprom) && memcmp (eeprom.cache, writeThroughExpected, MC24LC32_DATA_SIZE) == 0;
+}
+
+/// @brief Overwrites the schema's layout version in the cache.
+void schemaStoreVersion (uint16_t version)
+{
+	mc24lc32CacheWrite (&eeprom, SCHEMA_VERSION_ADDRESS, &version, sizeof (version));
+}
+
+// Entrypoint -----------------------------------------------------------------------------------------------------------------
+
+int main (int argc, char** argv)
+{
+	uint32_t seedCount = argc > 1 ? strtoul (argv [1], NULL, 0) : 8;
+	uint32_t journalUpdateCount = argc > 2 ? strtoul (argv [2], NULL, 0) : 200000;
+
+	i2cStart (&i2c, &i2cConfig);
+	mc24lc32SimInit (&sim, &i2c, DEVICE_ADDRESS);
+
+	printf ("Operation costs:\n");
+
+	// A blank device is invalid.
+	benchmarkBegin ();
+	bool result = !mc24lc32Init (&eeprom, &eepromConfig);
+	benchmarkEnd ("Init (blank device)", result);
+
+	benchmarkBegin ();
+	mc24lc32Validate (&eeprom);
+	result = mc24lc32Write (&eeprom);
+	benchmarkEnd ("Validate + full write", result);
+
+	benchmarkBegin ();
+	result = mc24lc32Commit (&eeprom);
+	benchmarkEnd ("Commit (nothing modified)", result);
+
+	benchmarkBegin ();
+	eeprom.cache [0x100] ^= 0xFF;
+	mc24lc32MarkDirty (&eeprom, 0x100, 1);
+	result = mc24lc32Commit (&eeprom);
+	benchmarkEnd ("Commit 1 byte (after full write)", result);
+
+	benchmarkBegin ();
+	eeprom.cache [0x100] ^= 0xFF;
+	mc24lc32MarkDirty (&eeprom, 0x100, 1);
+	result = mc24lc32Commit (&eeprom);
+	benchmarkEnd ("Commit 1 byte (steady state)", result);
+
+	uint8_t data [100];
+	memset (data, 0xA5, sizeof (data));
+	benchmarkBegin ();
+	result = mc24lc32WriteThrough (&eeprom, 0x20 + 20, data, sizeof (data));
+	benchmarkEnd ("Write-through 100 bytes (4 pages)", result);
+
+	benchmarkBegin ();
+	result = mc24lc32WriteThrough (&eeprom, MC24LC32_DATA_SIZE - 4, data, 8);
+	benchmarkEnd ("Write-through past the end (rejected)", !result);
+
+	benchmarkBegin ();
+	result = mc24lc32Read (&eeprom);
+	benchmarkEnd ("Read", result);
+
+	// Write-through contents, at various alignments.
+	printf ("\nWrite-through contents:\n");
+	memcpy (writeThroughExpected, eeprom.cache, MC24LC32_DATA_SIZE);
+
+	const struct
+	{
+		const char* name;
+		uint16_t address;
+		uint16_t count;
+	} writeThroughCases [] =
+	{
+		{ "Within a page", 0x0104, 8 },
+		{ "Crossing a page boundary", 0x013C, 8 },
+		{ "Aligned full page", 0x0160, MC24LC32_PAGE_SIZE },
+		{ "Unaligned across 4 pages", 0x0191, 100 },
+		{ "Crossing a region boundary", 0x01F0, 0x20 },
+		{ "Last bytes of the cache", MC24LC32_DATA_SIZE - 5, 5 },
+		{ "Crossing into the last page", MC24LC32_DATA_SIZE - MC24LC32_PAGE_SIZE - 3, 6 },
+		{ "Last page", MC24LC32_DATA_SIZE - MC24LC32_PAGE_SIZE, MC24LC32_PAGE_SIZE },
+		{ "All but the magic string's page", MC24LC32_PAGE_SIZE, MC24LC32_DATA_SIZE - MC24LC32_PAGE_SIZE }
+	};
+
+	for (uint8_t index = 0; index < sizeof (writeThroughCases) / sizeof (writeThroughCases [0]); ++index)
+	{
+		benchmarkBegin ();
+		result = writeThroughCheck (writeThroughCases [index].address, writeThroughCases [index].count);
+		benchmarkEnd (writeThroughCases [index].name, result);
+	}
+
+	// Rejected writes must not modify the device.
+	static uint8_t before [MC24LC32_SIM_SIZE];
+	memcpy (before, sim.memory, sizeof (before));
+	benchmarkBegin ();
+	result = !mc24lc32WriteThrough (&eeprom, MC24LC32_DATA_SIZE - 4, data, 8) &&
+		!mc24lc32WriteThrough (&eeprom, MC24LC32_DATA_SIZE + 1, data, 0) && memcmp (sim.memory, before, sizeof (before)) == 0;
+	benchmarkEnd ("Past the end (device unmodified)", result);
+
+	// Legacy layout: a single image of the entire memory, starting with the magic string. The data at the beginning of the
+	// image is already in bank 0, so only its commit record is written.
+	printf ("\nLegacy layout migration:\n");
+
+	memset (sim.memory, 0xFF, sizeof (sim.memory));
+	memcpy (sim.memory, MAGIC_STRING, sizeof (MAGIC_STRING));
+	memset (sim.memory + 0x0F0, 0x5A, 0x200);
+	mc24lc32SimPowerCycle (&sim);
+
+	benchmarkBegin ();
+	result = mc24lc32Init (&eeprom, &eepromConfig) && eeprom.cache [0x0F0] == 0x5A && eeprom.cache [0x2EF] == 0x5A &&
+		eeprom.cache [0x2F0] == 0xFF;
+	benchmarkEnd ("Migrate legacy image", result);
+
+	benchmarkBegin ();
+	result = mc24lc32Init (&eeprom, &eepromConfig) && mc24lc32IsRegionValid (&eeprom, 0, MC24LC32_DATA_SIZE) &&
+		eeprom.cache [0x0F0] == 0x5A;
+	benchmarkEnd ("Read migrated image", result);
+
+	// A legacy image using the memory past the end of the cache must be left untouched.
+	memset (sim.memory, 0xFF, sizeof (sim.memory));
+	memcpy (sim.memory, MAGIC_STRING, sizeof (MAGIC_STRING));
+	sim.memory [MC24LC32_SIM_SIZE - 1] = 0x5A;
+	mc24lc32SimPowerCycle (&sim);
+
+	static uint8_t legacy [MC24LC32_SIM_SIZE];
+	memcpy (legacy, sim.memory, sizeof (legacy));
+
+	benchmarkBegin ();
+	result = !mc24lc32Init (&eeprom, &eepromConfig) && eeprom.state == MC24LC32_STATE_LEGACY;
+	mc24lc32MarkDirty (&eeprom, 0, MC24LC32_DATA_SIZE);
+	result = result && !mc24lc32Commit (&eeprom) && memcmp (sim.memory, legacy, sizeof (legacy)) == 0;
+	benchmarkEnd ("Legacy image past the cache (rejected)", result);
+
+	// Discard the legacy image.
+	benchmarkBegin ();
+	mc24lc32Validate (&eeprom);
+	result = mc24lc32Write (&eeprom) && mc24lc32Init (&eeprom, &eepromConfig);
+	benchmarkEnd ("Discard legacy image", result);
+
+	// Power loss sweep: commit the old contents to both banks, then interrupt the commit of the new contents at each page
+	// write, until one completes.
+	printf ("\nPower loss sweep (%u seeds per point):\n", seedCount);
+
+	sweepFill (0x11);
+	mc24lc32Commit (&eeprom);
+	sweepFill (0x11);
+	mc24lc32Commit (&eeprom);
+
+	static uint8_t snapshot [MC24LC32_SIM_SIZE];
+	memcpy (snapshot, sim.memory, sizeof (snapshot));
+
+	uint32_t failureCount = 0;
+	bool completed = false;
+	for (uint32_t point = 0; !completed; ++point)
+	{
+		uint32_t outcomes [3] = { 0, 0, 0 };
+		for (uint32_t seed = 1; seed <= seedCount; ++seed)
+		{
+			memcpy (sim.memory, snapshot, sizeof (snapshot));
+			mc24lc32SimPowerCycle (&sim);
+			mc24lc32Init (&eeprom, &eepromConfig);
+
+			sweepFill (0x22);
+			mc24lc32SimSchedulePowerLoss (&sim, point, seed * 2654435761u);
+			// Note a commit is only complete if the power outlasted the write cycle of its last page write.
+			if (mc24lc32Commit (&eeprom) && sim.powered)
+				completed = true;
+
+			// Re-read the memory, as if after a reset.
+			mc24lc32SimPowerCycle (&sim);
+			mc24lc32Init (&eeprom, &eepromConfig);
+			++outcomes [sweepCheck (0x11, 0x22) + 1];
+		}
+
+		printf ("  Loss after %3u page writes: %3u old, %3u new, %3u corrupt\n", point, outcomes [1], outcomes [2],
+			outcomes [0]);
+
+		// After a completed commit, only the new contents are acceptable.
+		failureCount += outcomes [0] + (completed ? outcomes [1] : 0);
+	}
+
+	printf ("\n%s\n", failureCount == 0 ? "All power loss points recovered." : "Power loss recovery FAILED.");
+
+	// Parameter schema
+	printf ("\nParameter schema:\n");
+
+	benchmarkBegin ();
+	result = schemaSetTorqueLimit (&eeprom, 15.0f) && !schemaSetTorqueLimit (&eeprom, 21.5f) &&
+		!schemaSetTorqueLimit (&eeprom, NAN) && !schemaSetRegenEnabled (&eeprom, 2) && schemaGetTorqueLimit (&eeprom) == 15.0f;
+	benchmarkEnd ("Setters (range checked)", result);
+
+	// Version 1: in-range parameters are kept, out-of-range parameters and those of version 2 are reset.
+	schemaStoreVersion (1);
+	schemaSetTorqueLimit (&eeprom, 10.0f);
+	eeprom.cache [0x24] = 7;
+	memset (eeprom.cache + 0x28, 0xFF, sizeof (float));
+	benchmarkBegin ();
+	result = schemaMigrate (&eeprom) == 1 && schemaGetTorqueLimit (&eeprom) == 10.0f && schemaGetRegenEnabled (&eeprom) == 1 &&
+		schemaGetPedalDeadzone (&eeprom) == 0.05f;
+	benchmarkEnd ("Migrate from version 1", result);
+
+	// Blank or newer versions: everything is reset, even in-range values.
+	schemaStoreVersion (0xFFFF);
+	schemaSetTorqueLimit (&eeprom, 10.0f);
+	result = schemaMigrate (&eeprom) == 0xFFFF && schemaGetTorqueLimit (&eeprom) == 21.0f;
+	schemaStoreVersion (3);
+	schemaSetTorqueLimit (&eeprom, 10.0f);
+	benchmarkBegin ();
+	result = result && schemaMigrate (&eeprom) == 3 && schemaGetTorqueLimit (&eeprom) == 21.0f;
+	benchmarkEnd ("Migrate from blank / newer version", result);
+
+	// The parameters survive a commit and re-read.
+	schemaSetTorqueLimit (&eeprom, 12.5f);
+	benchmarkBegin ();
+	result = mc24lc32Commit (&eeprom) && mc24lc32Init (&eeprom, &eepromConfig) && schemaMigrate (&eeprom) == 2 &&
+		schemaGetTorqueLimit (&eeprom) == 12.5f && schemaGetPedalDeadzone (&eeprom) == 0.05f;
+	benchmarkEnd ("Commit and re-read", result);
+
+	// Regions are checked before their first modification, so a write does not invalidate an intact region. Note the read
+	// only checks the first region (containing the magic string).
+	benchmarkBegin ();
+	result = mc24lc32Init (&eeprom, &eepromConfig) && mc24lc32CacheWrite (&eeprom, 0x210, data, 4) &&
+		mc24lc32IsRegionValid (&eeprom, 0x210, 4);
+	benchmarkEnd ("Region modified before being checked", result);
+
+	// A corrupt region is still detected if it is modified before being checked.
+	uint8_t* corrupt = sim.memory + eeprom.activeBank * MC24LC32_BANK_SIZE + 0x150;
+	*corrupt ^= 0xFF;
+	mc24lc32SimPowerCycle (&sim);
+	benchmarkBegin ();
+	result = mc24lc32Init (&eeprom, &eepromConfig) && mc24lc32CacheWrite (&eeprom, 0x100, data, 4) &&
+		!mc24lc32IsRegionValid (&eeprom, 0x100, 4);
+	benchmarkEnd ("Corrupt region modified before check", result);
+	*corrupt ^= 0xFF;
+	mc24lc32SimPowerCycle (&sim);
+	mc24lc32Init (&eeprom, &eepromConfig);
+
+	// Sensor calibration
+	printf ("\nSensor calibration:\n");
+
+	// A calibration survives a save, a power cycle and a re-read, the reloaded sensor matching the calibrated one.
+	linearSensorConfig_t calibratedConfig = { .sampleMin = 1000, .sampleMax = 3000, .valueMin = 0.0f, .valueMax = 100.0f };
+	linearSensor_t calibrated;
+	linearSensorInit (&calibrated, &calibratedConfig);
+	linearSensorStartCalibration (&calibrated);
+	linearSensorUpdate (&calibrated, 2000);
+	linearSensorUpdate (&calibrated, 800);
+	linearSensorUpdate (&calibrated, 3200);
+	result = linearSensorFinishCalibration (&calibrated, 50);
+
+	linearSensorConfig_t loadedConfig = { .sampleMin = 1000, .sampleMax = 3000, .valueMin = 0.0f, .valueMax = 100.0f };
+	linearSensor_t loaded;
+	linearSensorInit (&loaded, &loadedConfig);
+	benchmarkBegin ();
+	result = result && linearSensorSaveCalibration (&calibrated, &eeprom, CALIBRATION_ADDRESS);
+	mc24lc32SimPowerCycle (&sim);
+	result = result && mc24lc32Init (&eeprom, &eepromConfig) &&
+		linearSensorLoadCalibration (&loaded, &eeprom, CALIBRATION_ADDRESS);
+	benchmarkEnd ("Save, power cycle and load", result);
+
+	benchmarkBegin ();
+	linearSensorUpdate (&loaded, 3250);
+	result = loadedConfig.sampleMin == 800 && loadedConfig.sampleMax == 3200 && loadedConfig.sampleMargin == 50 &&
+		loaded.validMin == 750 && loaded.validMax == 3250 && loaded.state == LINEAR_SENSOR_VALID &&
+		fabsf (loaded.value - 100.0f) < 1e-3f;
+	linearSensorUpdate (&loaded, 3251);
+	result = result && loaded.state == LINEAR_SENSOR_VALUE_INVALID;
+	benchmarkEnd ("Loaded calibration matches", result);
+
+	// Journal simulation
+	printf ("\nJournal:\n");
+
+	benchmarkBegin ();
+	result = mc24lc32JournalInit (&journal, &journalConfig) && !mc24lc32JournalWrite (&journal, JOURNAL_KEY_COUNT, 1) &&
+		mc24lc32JournalRead (&journal, JOURNAL_KEY_COUNT) == 0;
+	benchmarkEnd ("Key outside of the journal (rejected)", result);
+
+	uint32_t journalFailureCount = journalSimulate (journalUpdateCount);
+	printf ("\n%s\n", journalFailureCount == 0 ? "All journal updates recovered." : "Journal recovery FAILED.");
+
+	return failureCount == 0 && journalFailureCount == 0 && benchmarkFailureCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
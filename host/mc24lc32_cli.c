@@ -0,0 +1,1570 @@
+// MC24LC32 CAN Command-Line Tool -------------------------------------------------------------------------------------------
+//
+// Author: agent
+// Date Created: 2026.10.17
+//
+// Description: Host-side client of the EEPROM CAN protocol (see mc24lc32_can.h). Reads / writes the EEPROM's memory, dumps /
+//   restores the full image, validates / invalidates it and polls / subscribes to readonly variables, reporting the latency
+//   of each request and the throughput of each transfer, such that protocol changes can be measured end to end.
+//
+//   The tool runs against one of two buses:
+//   - Loopback (default): A host build of the firmware's command handler (mc24lc32_can.c), driving the mc24lc32 driver and a
+//     simulated 24LC32. The bus is simulated using the virtual clock, each frame taking its nominal transmission time (bit
+//     stuffing not included), so timings reflect the bus and the EEPROM, not the host. Frames may be dropped at random to
+//     exercise the protocol's recovery. The device's memory may be loaded from / saved to an image file, such that it
+//     persists across invocations.
+//   - SocketCAN: A CAN interface, either attached to a real node, or a virtual interface (ex. one replaying a recording
+//     using 'canplayer'). Timings are measured using the host's clock.
+//
+//   All traffic may be recorded to a log file, in the format of 'candump -l'.
+//
+// Usage: mc24lc32_cli [options] <command> [arguments] [<command> [arguments] ...]
+//   See printUsage.
+
+// POSIX APIs (clock_gettime, SocketCAN)
+#define _DEFAULT_SOURCE
+
+// Includes
+#include "can/mc24lc32_can.h"
+#include "can/mc24lc32_can_protocol.h"
+#include "peripherals/crc32.h"
+#include "peripherals/mc24lc32.h"
+#include "peripherals/mc24lc32_sim.h"
+
+// C Standard Library
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// SocketCAN
+#ifdef __linux__
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define SOCKETCAN_SUPPORTED 1
+#else
+#define SOCKETCAN_SUPPORTED 0
+#endif
+
+// Constants ------------------------------------------------------------------------------------------------------------------
+
+#define DEVICE_ADDRESS 0x50
+
+#define MAGIC_STRING "mc24lc32_cli"
+
+/// @brief Default ID of command messages. Responses use the following ID.
+#define COMMAND_ID_DEFAULT 0x700
+
+/// @brief Default window size of block transfers, in frames.
+#define WINDOW_DEFAULT 16
+
+/// @brief Default bitrate of the loopback bus.
+#define BITRATE_DEFAULT 1000000
+
+/// @brief Time to wait for the response to a request.
+#define RESPONSE_TIMEOUT_US 100000
+
+/// @brief Time to wait for the response to a request that commits to the EEPROM. A full image takes about 50 write cycles.
+#define COMMIT_TIMEOUT_US 1000000
+
+/// @brief Time to wait for the next frame of a block transfer before requesting a retransmission.
+#define BLOCK_TIMEOUT_US 20000
+
+/// @brief Number of times a request is repeated before failing.
+#define RETRY_COUNT 5
+
+/// @brief Number of consecutive retransmission requests without progress before a block transfer fails.
+#define BLOCK_RETRY_COUNT 16
+
+/// @brief Interval the loopback node's stream function is called at.
+#define LOOPBACK_TICK_US 100
+
+/// @brief Size of the loopback node's transmit queue, in frames.
+#define LOOPBACK_QUEUE_SIZE 256
+
+// Message Packaging ----------------------------------------------------------------------------------------------------------
+
+// See mc24lc32_can.c for the message formats, the extended commands being defined by mc24lc32_can_protocol.h.
+
+// Standard Command / Response Message
+#define INSTRUCTION_READ_NOT_WRITE(rnw)		(((uint16_t) (rnw))	<< 0)
+#define INSTRUCTION_DATA_NOT_VALIDATION(dnv)	(((uint16_t) (dnv))	<< 1)
+#define INSTRUCTION_IS_VALID(iv)			(((uint16_t) (iv))	<< 2)
+#define INSTRUCTION_DATA_COUNT(dc)			(((uint16_t) ((dc) - 1)) << 2)
+#define RESPONSE_IS_DATA_READ(byte)			(((byte) & 0b00010011) == 0b00000011)
+#define RESPONSE_IS_VALIDATION_READ(byte)	(((byte) & 0b00010011) == 0b00000001)
+#define RESPONSE_IS_VALID(byte)				(((byte) & 0b00000100) == 0b00000100)
+
+// Datatypes ------------------------------------------------------------------------------------------------------------------
+
+/// @brief A standard (11-bit ID) CAN frame, independent of the bus.
+typedef struct
+{
+	uint16_t id;
+	uint8_t dlc;
+	uint8_t data [8];
+} cliFrame_t;
+
+/// @brief Interface to the bus the tool is communicating over.
+typedef struct
+{
+	/// @brief Name of the bus, used in logs.
+	const char* name;
+
+	/// @brief Transmits a frame. Returns false if the frame could not be transmitted.
+	bool (*transmit) (const cliFrame_t* frame);
+
+	/// @brief Receives a frame, waiting at most the specified time. Returns false if no frame was received.
+	bool (*receive) (cliFrame_t* frame, uint32_t timeoutUs);
+
+	/// @brief Gets the current time of the bus, in microseconds.
+	uint64_t (*time) (void);
+} cliBus_t;
+
+/// @brief Latency statistics of a type of request.
+typedef struct
+{
+	const char* name;
+	uint32_t count;
+	uint32_t failures;
+	uint64_t totalUs;
+	uint64_t minUs;
+	uint64_t maxUs;
+} cliLatency_t;
+
+typedef enum
+{
+	LATENCY_DATA_READ		= 0,
+	LATENCY_DATA_WRITE		= 1,
+	LATENCY_VALIDATION		= 2,
+	LATENCY_TRANSACTION		= 3,
+	LATENCY_BLOCK_START		= 4,
+	LATENCY_BLOCK_END		= 5,
+	LATENCY_SUBSCRIBE		= 6,
+	LATENCY_COUNT			= 7
+} cliLatencyType_t;
+
+// Global Variables -----------------------------------------------------------------------------------------------------------
+
+static cliBus_t bus;
+
+static uint16_t commandId = COMMAND_ID_DEFAULT;
+
+static uint8_t window = WINDOW_DEFAULT;
+
+/// @brief Indicates transfers should use the standard (4 byte) commands rather than the block commands.
+static bool standardOnly = false;
+
+static FILE* logFile = NULL;
+
+static uint32_t transmitCount;
+static uint32_t receiveCount;
+
+/// @brief The size of each subscribed variable, indexed by slot, 0 if the slot is not subscribed.
+static uint8_t subscriptionSizes [MC24LC32_CAN_SUBSCRIPTION_COUNT];
+
+static cliLatency_t latencies [LATENCY_COUNT] =
+{
+	[LATENCY_DATA_READ]		= { .name = "Data read" },
+	[LATENCY_DATA_WRITE]	= { .name = "Data write (+ read back)" },
+	[LATENCY_VALIDATION]	= { .name = "Validation read" },
+	[LATENCY_TRANSACTION]	= { .name = "Transaction" },
+	[LATENCY_BLOCK_START]	= { .name = "Block start" },
+	[LATENCY_BLOCK_END]		= { .name = "Block end" },
+	[LATENCY_SUBSCRIBE]		= { .name = "Subscribe" }
+};
+
+// Loopback Bus ---------------------------------------------------------------------------------------------------------------
+
+static uint32_t loopbackBitrate = BITRATE_DEFAULT;
+
+/// @brief Probability of each frame being dropped, in percent.
+static uint32_t loopbackDropRate = 0;
+
+static uint32_t loopbackSeed = 1;
+
+static I2CDriver loopbackI2c;
+
+static const I2CConfig loopbackI2cConfig =
+{
+	.clock_speed = 400000
+};
+
+static mc24lc32Sim_t loopbackSim;
+
+static mc24lc32_t loopbackEeprom;
+
+static mc24lc32Config_t loopbackEepromConfig =
+{
+	.addr			= DEVICE_ADDRESS,
+	.i2c			= &loopbackI2c,
+	.timeoutPeriod	= TIME_MS2I (100),
+	.magicString	= MAGIC_STRING
+};
+
+static CANDriver loopbackCan;
+
+static mc24lc32Can_t loopbackNode;
+
+/// @brief Frames transmitted by the node, not yet received by the tool.
+static CANTxFrame loopbackQueue [LOOPBACK_QUEUE_SIZE];
+static uint16_t loopbackQueueHead = 0;
+static uint16_t loopbackQueueCount = 0;
+
+// Readonly variables of the loopback node
+static uint32_t loopbackUptime;
+static uint32_t loopbackPageWrites;
+static uint32_t loopbackBytesRead;
+static uint16_t loopbackTicks;
+
+static const mc24lc32CanVariable_t LOOPBACK_VARIABLES [] =
+{
+	{ .address = 0x1000, .size = 4, .data = &loopbackUptime },
+	{ .address = 0x1004, .size = 4, .data = &loopbackPageWrites },
+	{ .address = 0x1008, .size = 4, .data = &loopbackBytesRead },
+	{ .address = 0x100C, .size = 2, .data = &loopbackTicks }
+};
+
+// SocketCAN Bus --------------------------------------------------------------------------------------------------------------
+
+#if SOCKETCAN_SUPPORTED
+static int socketcanFd = -1;
+#endif // SOCKETCAN_SUPPORTED
+
+// Function Prototypes --------------------------------------------------------------------------------------------------------
+
+bool busTransmit (const cliFrame_t* frame);
+
+bool busReceive (cliFrame_t* frame, uint32_t timeoutUs);
+
+void busWait (uint32_t durationUs);
+
+void logFrame (const cliFrame_t* frame);
+
+void latencyRecord (cliLatencyType_t type, uint64_t startUs, bool result);
+
+bool request (cliLatencyType_t type, const cliFrame_t* command, cliFrame_t* response, uint32_t timeoutUs,
+	bool (*match) (const cliFrame_t* command, const cliFrame_t* response));
+
+bool matchDataRead (const cliFrame_t* command, const cliFrame_t* response);
+
+bool matchValidationRead (const cliFrame_t* command, const cliFrame_t* response);
+
+bool matchExtended (const cliFrame_t* command, const cliFrame_t* response);
+
+bool standardRead (uint16_t address, uint8_t* data, uint8_t count);
+
+void standardWrite (uint16_t address, const uint8_t* data, uint8_t count);
+
+bool validationRead (bool* isValid);
+
+bool transaction (uint8_t action);
+
+bool blockRead (uint16_t address, uint8_t* data, uint16_t count);
+
+bool blockWrite (uint16_t address, const uint8_t* data, uint16_t count);
+
+void sendBlockAck (uint16_t frameIndex, bool retransmit);
+
+void sendBlockEnd (uint32_t crc);
+
+bool transferRead (uint16_t address, uint8_t* data, uint16_t count);
+
+bool transferWrite (uint16_t address, const uint8_t* data, uint16_t count);
+
+void transferBegin (uint64_t* startUs);
+
+void transferEnd (const char* name, uint64_t startUs, uint32_t byteCount, bool result);
+
+bool loopbackInit (const char* imagePath);
+
+void loopbackDeinit (const char* imagePath);
+
+msg_t loopbackNodeTransmit (void* context, const CANTxFrame* frame);
+
+bool loopbackTransmit (const cliFrame_t* frame);
+
+bool loopbackReceive (cliFrame_t* frame, uint32_t timeoutUs);
+
+uint64_t loopbackTime (void);
+
+void loopbackAdvance (uint8_t dlc);
+
+bool loopbackDrop (void);
+
+void loopbackTick (void);
+
+bool socketcanInit (const char* interface);
+
+bool socketcanTransmit (const cliFrame_t* frame);
+
+bool socketcanReceive (cliFrame_t* frame, uint32_t timeoutUs);
+
+uint64_t socketcanTime (void);
+
+bool parseNumber (const char* string, uint32_t max, uint32_t* value);
+
+bool parseHex (const char* string, uint8_t* data, uint16_t* count, uint16_t max);
+
+void printData (uint16_t address, const uint8_t* data, uint16_t count);
+
+void printUsage (const char* name);
+
+int runCommand (int argc, char** argv, int* index);
+
+// Bus ------------------------------------------------------------------------------------------------------------------------
+
+bool busTransmit (const cliFrame_t* frame)
+{
+	if (!bus.transmit (frame))
+		return false;
+
+	++transmitCount;
+	logFrame (frame);
+	return true;
+}
+
+bool busReceive (cliFrame_t* frame, uint32_t timeoutUs)
+{
+	uint64_t endUs = bus.time () + timeoutUs;
+
+	while (true)
+	{
+		uint64_t timeUs = bus.time ();
+		if (!bus.receive (frame, timeUs < endUs ? endUs - timeUs : 0))
+			return false;
+
+		// Ignore anything but the responses
+		if (frame->id != commandId + 1)
+			continue;
+
+		++receiveCount;
+		logFrame (frame);
+		return true;
+	}
+}
+
+/// @brief Waits for the specified duration, discarding any received frames.
+void busWait (uint32_t durationUs)
+{
+	uint64_t endUs = bus.time () + durationUs;
+
+	cliFrame_t frame;
+	uint64_t timeUs;
+	while ((timeUs = bus.time ()) < endUs)
+		busReceive (&frame, endUs - timeUs);
+}
+
+void logFrame (const cliFrame_t* frame)
+{
+	if (logFile == NULL)
+		return;
+
+	uint64_t timeUs = bus.time ();
+	fprintf (logFile, "(%llu.%06llu) %s %03X#", (unsigned long long) (timeUs / 1000000),
+		(unsigned long long) (timeUs % 1000000), bus.name, frame->id);
+
+	for (uint8_t index = 0; index < frame->dlc; ++index)
+		fprintf (logFile, "%02X", frame->data [index]);
+
+	fprintf (logFile, "\n");
+}
+
+// Requests -------------------------------------------------------------------------------------------------------------------
+
+void latencyRecord (cliLatencyType_t type, uint64_t startUs, bool result)
+{
+	cliLatency_t* latency = &latencies [type];
+
+	if (!result)
+	{
+		++latency->failures;
+		return;
+	}
+
+	uint64_t durationUs = bus.time () - startUs;
+	if (latency->count == 0 || durationUs < latency->minUs)
+		latency->minUs = durationUs;
+	if (latency->count == 0 || durationUs > latency->maxUs)
+		latency->maxUs = durationUs;
+
+	latency->totalUs += durationUs;
+	++latency->count;
+}
+
+/// @brief Transmits a command and waits for its response, repeating the command if the response is not received in time.
+/// The latency is measured from the last transmission of the command.
+bool request (cliLatencyType_t type, const cliFrame_t* command, cliFrame_t* response, uint32_t timeoutUs,
+	bool (*match) (const cliFrame_t* command, const cliFrame_t* response))
+{
+	// Discard any responses to previous requests that arrived late.
+	while (busReceive (response, 0));
+
+	for (uint8_t attempt = 0; attempt < RETRY_COUNT; ++attempt)
+	{
+		uint64_t startUs = bus.time ();
+		if (!busTransmit (command))
+			continue;
+
+		uint64_t endUs = startUs + timeoutUs;
+		uint64_t timeUs;
+		while ((timeUs = bus.time ()) < endUs)
+		{
+			if (!busReceive (response, endUs - timeUs))
+				break;
+
+			if (match (command, response))
+			{
+				latencyRecord (type, startUs, true);
+				return true;
+			}
+		}
+	}
+
+	latencyRecord (type, 0, false);
+	return false;
+}
+
+bool matchDataRead (const cliFrame_t* command, const cliFrame_t* response)
+{
+	return RESPONSE_IS_DATA_READ (response->data [0]) && memcmp (command->data + 2, response->data + 2, 2) == 0;
+}
+
+bool matchValidationRead (const cliFrame_t* command, const cliFrame_t* response)
+{
+	(void) command;
+	return RESPONSE_IS_VALIDATION_READ (response->data [0]);
+}
+
+bool matchExtended (const cliFrame_t* command, const cliFrame_t* response)
+{
+	if (!EXTENDED_IS_EXTENDED (response->data [0]))
+		return false;
+
+	uint8_t opcode = EXTENDED_OPCODE (command->data [0]);
+	switch (opcode)
+	{
+	case OPCODE_TRANSACTION:
+	case OPCODE_SUBSCRIBE:
+		// Responses repeat the action / slot
+		return EXTENDED_OPCODE (response->data [0]) == opcode && response->data [1] == command->data [1];
+
+	case OPCODE_BLOCK_READ:
+		// Responded to by the first data frame, or a block end if rejected
+		return (EXTENDED_OPCODE (response->data [0]) == OPCODE_BLOCK_END && response->data [1] != MC24LC32_CAN_STATUS_OK) ||
+			(EXTENDED_OPCODE (response->data [0]) == OPCODE_BLOCK_DATA && response->data [1] == 0);
+
+	case OPCODE_BLOCK_WRITE:
+		// Responded to by an acknowledgement of frame 0, or a block end if rejected
+		return (EXTENDED_OPCODE (response->data [0]) == OPCODE_BLOCK_END && response->data [1] != MC24LC32_CAN_STATUS_OK) ||
+			(EXTENDED_OPCODE (response->data [0]) == OPCODE_BLOCK_ACK && response->data [1] == 0);
+
+	default:
+		return false;
+	}
+}
+
+bool standardRead (uint16_t address, uint8_t* data, uint8_t count)
+{
+	cliFrame_t command =
+	{
+		.id		= commandId,
+		.dlc	= 4
+	};
+
+	uint16_t instruction = INSTRUCTION_READ_NOT_WRITE (true) | INSTRUCTION_DATA_NOT_VALIDATION (true) |
+		INSTRUCTION_DATA_COUNT (count);
+	memcpy (command.data, &instruction, sizeof (instruction));
+	memcpy (command.data + 2, &address, sizeof (address));
+
+	cliFrame_t response;
+	if (!request (LATENCY_DATA_READ, &command, &response, RESPONSE_TIMEOUT_US, matchDataRead))
+		return false;
+
+	memcpy (data, response.data + 4, count);
+	return true;
+}
+
+/// @brief Transmits a data write. Note data writes are not responded to.
+void standardWrite (uint16_t address, const uint8_t* data, uint8_t count)
+{
+	cliFrame_t command =
+	{
+		.id		= commandId,
+		.dlc	= 4 + count
+	};
+
+	uint16_t instruction = INSTRUCTION_READ_NOT_WRITE (false) | INSTRUCTION_DATA_NOT_VALIDATION (true) |
+		INSTRUCTION_DATA_COUNT (count);
+	memcpy (command.data, &instruction, sizeof (instruction));
+	memcpy (command.data + 2, &address, sizeof (address));
+	memcpy (command.data + 4, data, count);
+
+	busTransmit (&command);
+}
+
+bool validationRead (bool* isValid)
+{
+	cliFrame_t command =
+	{
+		.id		= commandId,
+		.dlc	= 2,
+		.data	= { INSTRUCTION_READ_NOT_WRITE (true) | INSTRUCTION_DATA_NOT_VALIDATION (false) }
+	};
+
+	cliFrame_t response;
+	if (!request (LATENCY_VALIDATION, &command, &response, RESPONSE_TIMEOUT_US, matchValidationRead))
+		return false;
+
+	*isValid = RESPONSE_IS_VALID (response.data [0]);
+	return true;
+}
+
+bool transaction (uint8_t action)
+{
+	cliFrame_t command =
+	{
+		.id		= commandId,
+		.dlc	= 2,
+		.data	= { EXTENDED_INSTRUCTION (OPCODE_TRANSACTION, false), action }
+	};
+
+	cliFrame_t response;
+	uint32_t timeoutUs = action == TRANSACTION_COMMIT ? COMMIT_TIMEOUT_US : RESPONSE_TIMEOUT_US;
+	if (!request (LATENCY_TRANSACTION, &command, &response, timeoutUs, matchExtended))
+		return false;
+
+	if (response.data [2] != MC24LC32_CAN_STATUS_OK)
+	{
+		fprintf (stderr, "Transaction action %u failed, status %u.\n", action, response.data [2]);
+		return false;
+	}
+
+	return true;
+}
+
+bool blockRead (uint16_t address, uint8_t* data, uint16_t count)
+{
+	uint16_t frameCount = (count + BLOCK_FRAME_SIZE - 1) / BLOCK_FRAME_SIZE;
+	uint8_t ackInterval = window / 2 > 0 ? window / 2 : 1;
+
+	cliFrame_t command =
+	{
+		.id		= commandId,
+		.dlc	= 6,
+		.data	= { EXTENDED_INSTRUCTION (OPCODE_BLOCK_READ, false), window }
+	};
+	memcpy (command.data + 2, &address, sizeof (address));
+	memcpy (command.data + 4, &count, sizeof (count));
+
+	// The first response is either the first frame or a rejection.
+	cliFrame_t frame;
+	if (!request (LATENCY_BLOCK_START, &command, &frame, RESPONSE_TIMEOUT_US, matchExtended))
+		return false;
+
+	uint16_t received = 0;
+	uint16_t acked = 0;
+	bool retransmitRequested = false;
+	uint8_t retries = 0;
+
+	while (true)
+	{
+		if (EXTENDED_IS_EXTENDED (frame.data [0]) && EXTENDED_OPCODE (frame.data [0]) == OPCODE_BLOCK_DATA)
+		{
+			uint8_t offset = frame.data [1] - (uint8_t) received;
+			if (offset == 0 && received < frameCount)
+			{
+				// Next frame in the sequence, the last may be partial.
+				uint16_t dataCount = count - received * BLOCK_FRAME_SIZE;
+				if (dataCount > BLOCK_FRAME_SIZE)
+					dataCount = BLOCK_FRAME_SIZE;
+
+				memcpy (data + received * BLOCK_FRAME_SIZE, frame.data + 2, dataCount);
+				++received;
+				retransmitRequested = false;
+				retries = 0;
+
+				if (received != frameCount && received - acked >= ackInterval)
+				{
+					sendBlockAck (received, false);
+					acked = received;
+				}
+			}
+			else if (offset < 128 && !retransmitRequested)
+			{
+				// Gap in the sequence, request a retransmission from the first missing frame, once per gap. Frames prior
+				// to the expected one are repeats, and are ignored.
+				sendBlockAck (received, true);
+				acked = received;
+				retransmitRequested = true;
+			}
+		}
+		else if (EXTENDED_IS_EXTENDED (frame.data [0]) && EXTENDED_OPCODE (frame.data [0]) == OPCODE_BLOCK_END)
+		{
+			if (frame.data [1] != MC24LC32_CAN_STATUS_OK)
+			{
+				fprintf (stderr, "Block read rejected, status %u.\n", frame.data [1]);
+				return false;
+			}
+
+			if (received != frameCount)
+			{
+				// The end overtook missing frames, request them.
+				sendBlockAck (received, true);
+				acked = received;
+				retransmitRequested = true;
+			}
+			else
+			{
+				// Acknowledge the final frame to end the transfer.
+				sendBlockAck (received, false);
+
+				uint32_t crc;
+				memcpy (&crc, frame.data + 2, sizeof (crc));
+				if (crc != crc32Calculate (data, count))
+				{
+					fprintf (stderr, "Block read CRC mismatch.\n");
+					return false;
+				}
+
+				return true;
+			}
+		}
+
+		// Wait for the next frame. If it does not arrive in time, request a retransmission from the first missing frame.
+		while (!busReceive (&frame, BLOCK_TIMEOUT_US))
+		{
+			if (++retries > BLOCK_RETRY_COUNT)
+			{
+				fprintf (stderr, "Block read timed out at frame %u of %u.\n", received, frameCount);
+				return false;
+			}
+
+			sendBlockAck (received, true);
+			acked = received;
+			retransmitRequested = true;
+		}
+	}
+}
+
+bool blockWrite (uint16_t address, const uint8_t* data, uint16_t count)
+{
+	uint16_t frameCount = (count + BLOCK_FRAME_SIZE - 1) / BLOCK_FRAME_SIZE;
+	uint32_t crc = crc32Calculate (data, count);
+
+	cliFrame_t command =
+	{
+		.id		= commandId,
+		.dlc	= 6,
+		.data	= { EXTENDED_INSTRUCTION (OPCODE_BLOCK_WRITE, false), window }
+	};
+	memcpy (command.data + 2, &address, sizeof (address));
+	memcpy (command.data + 4, &count, sizeof (count));
+
+	// Wait for the node to be ready (acknowledgement of frame 0), or a rejection.
+	cliFrame_t frame;
+	if (!request (LATENCY_BLOCK_START, &command, &frame, RESPONSE_TIMEOUT_US, matchExtended))
+		return false;
+
+	if (EXTENDED_OPCODE (frame.data [0]) == OPCODE_BLOCK_END)
+	{
+		fprintf (stderr, "Block write rejected, status %u.\n", frame.data [1]);
+		return false;
+	}
+
+	uint16_t next = 0;
+	uint16_t acked = 0;
+	bool endSent = false;
+	uint64_t endUs = 0;
+	uint8_t retries = 0;
+
+	while (true)
+	{
+		// Send the frames that fit in the window, followed by the block end.
+		while (next < frameCount && next - acked < window)
+		{
+			uint16_t dataCount = count - next * BLOCK_FRAME_SIZE;
+			if (dataCount > BLOCK_FRAME_SIZE)
+				dataCount = BLOCK_FRAME_SIZE;
+
+			cliFrame_t dataFrame =
+			{
+				.id		= commandId,
+				.dlc	= 2 + dataCount,
+				.data	= { EXTENDED_INSTRUCTION (OPCODE_BLOCK_DATA, false), (uint8_t) next }
+			};
+			memcpy (dataFrame.data + 2, data + next * BLOCK_FRAME_SIZE, dataCount);
+
+			// If the frame cannot be sent, the node will request its retransmission.
+			if (!busTransmit (&dataFrame))
+				break;
+
+			++next;
+		}
+
+		if (next == frameCount && !endSent)
+		{
+			endUs = bus.time ();
+			sendBlockEnd (crc);
+			endSent = true;
+		}
+
+		// Once every frame is acknowledged, the status may take a commit to arrive.
+		if (!busReceive (&frame, acked == frameCount ? COMMIT_TIMEOUT_US : BLOCK_TIMEOUT_US))
+		{
+			if (++retries > BLOCK_RETRY_COUNT)
+			{
+				fprintf (stderr, "Block write timed out at frame %u of %u.\n", acked, frameCount);
+				return false;
+			}
+
+			// The node always responds to a block end, either with the status or a retransmission request.
+			endUs = bus.time ();
+			sendBlockEnd (crc);
+			endSent = true;
+			continue;
+		}
+
+		if (!EXTENDED_IS_EXTENDED (frame.data [0]))
+			continue;
+
+		uint8_t opcode = EXTENDED_OPCODE (frame.data [0]);
+		if (opcode == OPCODE_BLOCK_ACK)
+		{
+			// Reconstruct the frame index from the sequence number.
+			uint16_t index = acked + (uint8_t) (frame.data [1] - (uint8_t) acked);
+			if (index > next)
+				continue;
+
+			if (index > acked)
+				retries = 0;
+
+			acked = index;
+
+			// Go back to the first missing frame, if requested.
+			if (EXTENDED_RETRANSMIT (frame.data [0]))
+			{
+				next = index;
+				endSent = false;
+			}
+		}
+		else if (opcode == OPCODE_BLOCK_END && endSent)
+		{
+			latencyRecord (LATENCY_BLOCK_END, endUs, true);
+
+			if (frame.data [1] != MC24LC32_CAN_STATUS_OK)
+			{
+				fprintf (stderr, "Block write failed, status %u.\n", frame.data [1]);
+				return false;
+			}
+
+			return true;
+		}
+	}
+}
+
+void sendBlockAck (uint16_t frameIndex, bool retransmit)
+{
+	cliFrame_t frame =
+	{
+		.id		= commandId,
+		.dlc	= 2,
+		.data	= { EXTENDED_INSTRUCTION (OPCODE_BLOCK_ACK, retransmit), (uint8_t) frameIndex }
+	};
+
+	busTransmit (&frame);
+}
+
+void sendBlockEnd (uint32_t crc)
+{
+	cliFrame_t frame =
+	{
+		.id		= commandId,
+		.dlc	= 6,
+		.data	= { EXTENDED_INSTRUCTION (OPCODE_BLOCK_END, false) }
+	};
+	memcpy (frame.data + 2, &crc, sizeof (crc));
+
+	busTransmit (&frame);
+}
+
+// Transfers ------------------------------------------------------------------------------------------------------------------
+
+/// @brief Reads a range of memory, using a block read if supported by the range, standard reads otherwise.
+bool transferRead (uint16_t address, uint8_t* data, uint16_t count)
+{
+	// Block reads only cover the EEPROM's cache, and a single read covers 4 bytes.
+	if (!standardOnly && count > 4 && address < MC24LC32_DATA_SIZE)
+		return blockRead (address, data, count);
+
+	for (uint16_t offset = 0; offset < count; offset += 4)
+	{
+		uint8_t chunk = count - offset < 4 ? count - offset : 4;
+		if (!standardRead (address + offset, data + offset, chunk))
+			return false;
+	}
+
+	return true;
+}
+
+/// @brief Writes a range of memory, using a block write if supported by the range, otherwise standard writes grouped into
+/// a transaction (such that they are committed once, and the commit's response indicates completion).
+bool transferWrite (uint16_t address, const uint8_t* data, uint16_t count)
+{
+	if (!standardOnly && count > 4)
+		return blockWrite (address, data, count);
+
+	if (count <= 4)
+	{
+		// Writes are not responded to, read the data back to measure completion.
+		uint64_t startUs = bus.time ();
+		standardWrite (address, data, count);
+
+		uint8_t readback [4];
+		bool result = standardRead (address, readback, count) && memcmp (data, readback, count) == 0;
+		latencyRecord (LATENCY_DATA_WRITE, startUs, result);
+		return result;
+	}
+
+	if (!transaction (TRANSACTION_BEGIN))
+		return false;
+
+	for (uint16_t offset = 0; offset < count; offset += 4)
+	{
+		uint8_t chunk = count - offset < 4 ? count - offset : 4;
+		standardWrite (address + offset, data + offset, chunk);
+	}
+
+	return transaction (TRANSACTION_COMMIT);
+}
+
+void transferBegin (uint64_t* startUs)
+{
+	transmitCount = 0;
+	receiveCount = 0;
+	*startUs = bus.time ();
+}
+
+void transferEnd (const char* name, uint64_t startUs, uint32_t byteCount, bool result)
+{
+	uint64_t durationUs = bus.time () - startUs;
+	printf ("%-10s %-4s %5u bytes in %9.3f ms", name, result ? "ok" : "FAIL", byteCount, durationUs / 1000.0);
+
+	if (byteCount != 0 && durationUs != 0)
+		printf (" (%7.2f KiB/s)", byteCount * 1000000.0 / durationUs / 1024.0);
+
+	printf (", %u frames sent, %u received\n", transmitCount, receiveCount);
+}
+
+// Loopback Bus ---------------------------------------------------------------------------------------------------------------
+
+bool loopbackInit (const char* imagePath)
+{
+	i2cStart (&loopbackI2c, &loopbackI2cConfig);
+	mc24lc32SimInit (&loopbackSim, &loopbackI2c, DEVICE_ADDRESS);
+
+	if (imagePath != NULL)
+	{
+		// A missing image is a blank device.
+		FILE* file = fopen (imagePath, "rb");
+		if (file != NULL)
+		{
+			size_t count = fread (loopbackSim.memory, 1, sizeof (loopbackSim.memory), file);
+			fclose (file);
+
+			if (count != sizeof (loopbackSim.memory))
+			{
+				fprintf (stderr, "Device image '%s' must be %u bytes.\n", imagePath, MC24LC32_SIM_SIZE);
+				return false;
+			}
+		}
+	}
+
+	// An invalid memory is not an error, the tool may be used to restore it.
+	mc24lc32Init (&loopbackEeprom, &loopbackEepromConfig);
+
+	loopbackCan.transmit = loopbackNodeTransmit;
+	loopbackCan.bus = NULL;
+
+	mc24lc32CanConfig_t config =
+	{
+		.driver				= &loopbackCan,
+		.eeprom				= &loopbackEeprom,
+		.readonlyCallback	= NULL,
+		.variables			= LOOPBACK_VARIABLES,
+		.variableCount		= sizeof (LOOPBACK_VARIABLES) / sizeof (LOOPBACK_VARIABLES [0])
+	};
+	if (!mc24lc32CanInit (&loopbackNode, &config))
+	{
+		fprintf (stderr, "Loopback readonly variable registry is invalid.\n");
+		return false;
+	}
+
+	loopbackTick ();
+
+	bus.name		= "loopback";
+	bus.transmit	= loopbackTransmit;
+	bus.receive		= loopbackReceive;
+	bus.time		= loopbackTime;
+
+	return true;
+}
+
+void loopbackDeinit (const char* imagePath)
+{
+	if (imagePath == NULL)
+		return;
+
+	FILE* file = fopen (imagePath, "wb");
+	if (file == NULL || fwrite (loopbackSim.memory, 1, sizeof (loopbackSim.memory), file) != sizeof (loopbackSim.memory))
+		fprintf (stderr, "Failed to save device image '%s': %s\n", imagePath, strerror (errno));
+
+	if (file != NULL)
+		fclose (file);
+}
+
+/// @brief Transmit handler of the node's CAN driver, queues the frame to be received by the tool.
+msg_t loopbackNodeTransmit (void* context, const CANTxFrame* frame)
+{
+	(void) context;
+
+	// The bus is busy for the duration of the frame, regardless of whether anything receives it.
+	loopbackAdvance (frame->DLC);
+
+	if (loopbackQueueCount == LOOPBACK_QUEUE_SIZE)
+		return MSG_TIMEOUT;
+
+	if (loopbackDrop ())
+		return MSG_OK;
+
+	loopbackQueue [(loopbackQueueHead + loopbackQueueCount) % LOOPBACK_QUEUE_SIZE] = *frame;
+	++loopbackQueueCount;
+	return MSG_OK;
+}
+
+bool loopbackTransmit (const cliFrame_t* frame)
+{
+	loopbackAdvance (frame->dlc);
+
+	if (loopbackDrop ())
+		return true;
+
+	CANRxFrame rxFrame =
+	{
+		.DLC	= frame->dlc,
+		.IDE	= CAN_IDE_STD,
+		.SID	= frame->id
+	};
+	memcpy (rxFrame.data8, frame->data, sizeof (rxFrame.data8));
+
+	// The node handles the command immediately, any responses are queued.
+	mc24lc32CanHandleCommand (&loopbackNode, &rxFrame);
+	return true;
+}
+
+bool loopbackReceive (cliFrame_t* frame, uint32_t timeoutUs)
+{
+	systime_t start = chVTGetSystemTime ();
+
+	// Run the node until it transmits something, or the timeout expires.
+	while (loopbackQueueCount == 0)
+	{
+		if (chTimeDiffX (start, chVTGetSystemTime ()) >= TIME_US2I (timeoutUs))
+			return false;
+
+		chThdSleep (TIME_US2I (LOOPBACK_TICK_US));
+		loopbackTick ();
+	}
+
+	CANTxFrame* txFrame = &loopbackQueue [loopbackQueueHead];
+	loopbackQueueHead = (loopbackQueueHead + 1) % LOOPBACK_QUEUE_SIZE;
+	--loopbackQueueCount;
+
+	frame->id	= txFrame->SID;
+	frame->dlc	= txFrame->DLC;
+	memcpy (frame->data, txFrame->data8, sizeof (frame->data));
+	return true;
+}
+
+uint64_t loopbackTime (void)
+{
+	return TIME_I2US (chVTGetSystemTime ());
+}
+
+/// @brief Advances the clock by the nominal duration of a standard frame (47 bits of overhead plus the data, excluding bit
+/// stuffing).
+void loopbackAdvance (uint8_t dlc)
+{
+	uint32_t bitCount = 47 + 8 * dlc;
+	hostClockAdvance (TIME_US2I ((bitCount * 1000000 + loopbackBitrate - 1) / loopbackBitrate));
+}
+
+bool loopbackDrop (void)
+{
+	if (loopbackDropRate == 0)
+		return false;
+
+	// Xorshift
+	loopbackSeed ^= loopbackSeed << 13;
+	loopbackSeed ^= loopbackSeed >> 17;
+	loopbackSeed ^= loopbackSeed << 5;
+	return loopbackSeed % 100 < loopbackDropRate;
+}
+
+/// @brief Updates the node's readonly variables and streams any subscriptions that are due.
+void loopbackTick (void)
+{
+	loopbackUptime		= TIME_I2MS (chVTGetSystemTime ());
+	loopbackPageWrites	= loopbackSim.pageWriteCount;
+	loopbackBytesRead	= loopbackSim.readByteCount;
+	++loopbackTicks;
+
+	mc24lc32CanStream (&loopbackNode);
+}
+
+// SocketCAN Bus --------------------------------------------------------------------------------------------------------------
+
+#if SOCKETCAN_SUPPORTED
+
+bool socketcanInit (const char* interface)
+{
+	socketcanFd = socket (PF_CAN, SOCK_RAW, CAN_RAW);
+	if (socketcanFd < 0)
+	{
+		fprintf (stderr, "Failed to open CAN socket: %s\n", strerror (errno));
+		return false;
+	}
+
+	struct ifreq ifr;
+	memset (&ifr, 0, sizeof (ifr));
+	strncpy (ifr.ifr_name, interface, IFNAMSIZ - 1);
+	if (ioctl (socketcanFd, SIOCGIFINDEX, &ifr) < 0)
+	{
+		fprintf (stderr, "Failed to find CAN interface '%s': %s\n", interface, strerror (errno));
+		return false;
+	}
+
+	struct sockaddr_can address =
+	{
+		.can_family		= AF_CAN,
+		.can_ifindex	= ifr.ifr_ifindex
+	};
+	if (bind (socketcanFd, (struct sockaddr*) &address, sizeof (address)) < 0)
+	{
+		fprintf (stderr, "Failed to bind CAN socket: %s\n", strerror (errno));
+		return false;
+	}
+
+	// Only receive the responses
+	struct can_filter filter =
+	{
+		.can_id		= commandId + 1,
+		.can_mask	= CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG
+	};
+	setsockopt (socketcanFd, SOL_CAN_RAW, CAN_RAW_FILTER, &filter, sizeof (filter));
+
+	bus.name		= interface;
+	bus.transmit	= socketcanTransmit;
+	bus.receive		= socketcanReceive;
+	bus.time		= socketcanTime;
+
+	return true;
+}
+
+bool socketcanTransmit (const cliFrame_t* frame)
+{
+	struct can_frame canFrame =
+	{
+		.can_id		= frame->id,
+		.can_dlc	= frame->dlc
+	};
+	memcpy (canFrame.data, frame->data, sizeof (canFrame.data));
+
+	// If the transmit queue is full, wait for it to drain.
+	struct pollfd descriptor = { .fd = socketcanFd, .events = POLLOUT };
+	for (uint8_t attempt = 0; attempt < RETRY_COUNT; ++attempt)
+	{
+		if (write (socketcanFd, &canFrame, sizeof (canFrame)) == sizeof (canFrame))
+			return true;
+
+		if (errno != ENOBUFS && errno != EAGAIN)
+			break;
+
+		poll (&descriptor, 1, 10);
+	}
+
+	return false;
+}
+
+bool socketcanReceive (cliFrame_t* frame, uint32_t timeoutUs)
+{
+	struct pollfd descriptor = { .fd = socketcanFd, .events = POLLIN };
+	if (poll (&descriptor, 1, (timeoutUs + 999) / 1000) <= 0)
+		return false;
+
+	struct can_frame canFrame;
+	if (read (socketcanFd, &canFrame, sizeof (canFrame)) != sizeof (canFrame))
+		return false;
+
+	frame->id	= canFrame.can_id & CAN_SFF_MASK;
+	frame->dlc	= canFrame.can_dlc;
+	memcpy (frame->data, canFrame.data, sizeof (frame->data));
+	return true;
+}
+
+uint64_t socketcanTime (void)
+{
+	struct timespec time;
+	clock_gettime (CLOCK_MONOTONIC, &time);
+	return (uint64_t) time.tv_sec * 1000000 + time.tv_nsec / 1000;
+}
+
+#else
+
+bool socketcanInit (const char* interface)
+{
+	(void) interface;
+	fprintf (stderr, "SocketCAN is not supported on this platform.\n");
+	return false;
+}
+
+#endif // SOCKETCAN_SUPPORTED
+
+// Commands -------------------------------------------------------------------------------------------------------------------
+
+bool parseNumber (const char* string, uint32_t max, uint32_t* value)
+{
+	char* end;
+	errno = 0;
+	unsigned long result = strtoul (string, &end, 0);
+	if (errno != 0 || *end != '\0' || end == string || result > max)
+	{
+		fprintf (stderr, "Invalid number '%s'.\n", string);
+		return false;
+	}
+
+	*value = result;
+	return true;
+}
+
+bool parseHex (const char* string, uint8_t* data, uint16_t* count, uint16_t max)
+{
+	size_t length = strlen (string);
+	if (length == 0 || length % 2 != 0 || length / 2 > max)
+	{
+		fprintf (stderr, "Invalid data '%s', expected 1 to %u bytes of hex.\n", string, max);
+		return false;
+	}
+
+	for (size_t index = 0; index < length / 2; ++index)
+	{
+		unsigned int byte;
+		if (sscanf (string + index * 2, "%2x", &byte) != 1)
+		{
+			fprintf (stderr, "Invalid data '%s'.\n", string);
+			return false;
+		}
+
+		data [index] = byte;
+	}
+
+	*count = length / 2;
+	return true;
+}
+
+void printData (uint16_t address, const uint8_t* data, uint16_t count)
+{
+	for (uint16_t offset = 0; offset < count; offset += 16)
+	{
+		printf ("  0x%04X:", address + offset);
+		for (uint16_t index = offset; index < count && index < offset + 16; ++index)
+			printf (" %02X", data [index]);
+		printf ("\n");
+	}
+}
+
+void printUsage (const char* name)
+{
+	fprintf (stderr,
+		"Usage: %s [options] <command> [arguments] [<command> [arguments] ...]\n"
+		"\n"
+		"Options:\n"
+		"  --loopback               Use a host build of the firmware's command handler (default).\n"
+		"  --socketcan <interface>  Use a SocketCAN interface.\n"
+		"  --id <id>                ID of command messages, responses use the following ID (default 0x%03X).\n"
+		"  --window <frames>        Window size of block transfers (default %u).\n"
+		"  --standard               Transfer using the standard (4 byte) commands only.\n"
+		"  --log <file>             Record all traffic, in the format of 'candump -l'.\n"
+		"  --image <file>           (Loopback) Load / save the simulated device's memory from / to a file.\n"
+		"  --bitrate <bps>          (Loopback) Bitrate of the bus (default %u).\n"
+		"  --drop <percent>         (Loopback) Probability of dropping each frame.\n"
+		"\n"
+		"Commands:\n"
+		"  read <address> <count>                    Read a range of memory.\n"
+		"  write <address> <hex>                     Write a range of memory.\n"
+		"  dump <file>                               Read the full image into a file.\n"
+		"  restore <file>                            Write the full image from a file.\n"
+		"  valid                                     Check whether the image is valid.\n"
+		"  validate                                  Validate the image.\n"
+		"  invalidate                                Invalidate the image.\n"
+		"  poll <address> <size> <count> <ms>        Read a readonly variable periodically.\n"
+		"  subscribe <slot> <address> <size> <ms>    Subscribe to a readonly variable (0 ms to unsubscribe).\n"
+		"  listen <ms>                               Print the streamed values of the subscriptions.\n"
+		"  wait <ms>                                 Do nothing for a duration.\n",
+		name, COMMAND_ID_DEFAULT, WINDOW_DEFAULT, BITRATE_DEFAULT);
+}
+
+/// @brief Runs the command at the specified index, advancing the index past its arguments.
+/// @return 0 if successful, 1 if the command failed, 2 if the command was invalid.
+int runCommand (int argc, char** argv, int* index)
+{
+	const char* name = argv [*index];
+	char** arguments = argv + *index + 1;
+	int argumentCount = argc - *index - 1;
+
+	uint64_t startUs;
+	uint32_t values [4];
+
+	if (strcmp (name, "read") == 0 && argumentCount >= 2)
+	{
+		*index += 3;
+		if (!parseNumber (arguments [0], UINT16_MAX, &values [0]) || !parseNumber (arguments [1], UINT16_MAX, &values [1]))
+			return 2;
+
+		uint8_t* data = malloc (values [1]);
+		transferBegin (&startUs);
+		bool result = transferRead (values [0], data, values [1]);
+		transferEnd ("read", startUs, values [1], result);
+		if (result)
+			printData (values [0], data, values [1]);
+
+		free (data);
+		return result ? 0 : 1;
+	}
+
+	if (strcmp (name, "write") == 0 && argumentCount >= 2)
+	{
+		*index += 3;
+		uint8_t data [MC24LC32_DATA_SIZE];
+		uint16_t count;
+		if (!parseNumber (arguments [0], UINT16_MAX, &values [0]) || !parseHex (arguments [1], data, &count, sizeof (data)))
+			return 2;
+
+		transferBegin (&startUs);
+		bool result = transferWrite (values [0], data, count);
+		transferEnd ("write", startUs, count, result);
+		return result ? 0 : 1;
+	}
+
+	if (strcmp (name, "dump") == 0 && argumentCount >= 1)
+	{
+		*index += 2;
+		uint8_t data [MC24LC32_DATA_SIZE];
+
+		transferBegin (&startUs);
+		bool result = transferRead (0, data, sizeof (data));
+		transferEnd ("dump", startUs, sizeof (data), result);
+		if (!result)
+			return 1;
+
+		FILE* file = fopen (arguments [0], "wb");
+		if (file == NULL || fwrite (data, 1, sizeof (data), file) != sizeof (data))
+		{
+			fprintf (stderr, "Failed to write '%s': %s\n", arguments [0], strerror (errno));
+			result = false;
+		}
+
+		if (file != NULL)
+			fclose (file);
+
+		return result ? 0 : 1;
+	}
+
+	if (strcmp (name, "restore") == 0 && argumentCount >= 1)
+	{
+		*index += 2;
+		uint8_t data [MC24LC32_DATA_SIZE];
+
+		FILE* file = fopen (arguments [0], "rb");
+		if (file == NULL)
+		{
+			fprintf (stderr, "Failed to open '%s': %s\n", arguments [0], strerror (errno));
+			return 1;
+		}
+
+		// Images shorter than the memory restore only its beginning.
+		size_t count = fread (data, 1, sizeof (data), file);
+		fclose (file);
+
+		transferBegin (&startUs);
+		bool result = count != 0 && transferWrite (0, data, count);
+		transferEnd ("restore", startUs, count, result);
+		return result ? 0 : 1;
+	}
+
+	if (strcmp (name, "valid") == 0)
+	{
+		*index += 1;
+		bool isValid;
+		transferBegin (&startUs);
+		bool result = validationRead (&isValid);
+		transferEnd ("valid", startUs, 0, result);
+		if (result)
+			printf ("  Image is %s.\n", isValid ? "valid" : "invalid");
+
+		return result ? 0 : 1;
+	}
+
+	if (strcmp (name, "validate") == 0 || strcmp (name, "invalidate") == 0)
+	{
+		*index += 1;
+		bool valid = strcmp (name, "validate") == 0;
+		cliFrame_t command =
+		{
+			.id		= commandId,
+			.dlc	= 2,
+			.data	=
+			{
+				INSTRUCTION_READ_NOT_WRITE (false) | INSTRUCTION_DATA_NOT_VALIDATION (false) | INSTRUCTION_IS_VALID (valid)
+			}
+		};
+
+		// Validation writes are not responded to, read the validity back to confirm.
+		bool isValid;
+		transferBegin (&startUs);
+		bool result = busTransmit (&command) && validationRead (&isValid) && isValid == valid;
+		transferEnd (name, startUs, 0, result);
+		return result ? 0 : 1;
+	}
+
+	if (strcmp (name, "poll") == 0 && argumentCount >= 4)
+	{
+		*index += 5;
+		if (!parseNumber (arguments [0], UINT16_MAX, &values [0]) || !parseNumber (arguments [1], 4, &values [1]) ||
+			!parseNumber (arguments [2], UINT32_MAX, &values [2]) || !parseNumber (arguments [3], UINT32_MAX / 1000,
+			&values [3]))
+			return 2;
+
+		bool result = true;
+		transferBegin (&startUs);
+		for (uint32_t poll = 0; poll < values [2]; ++poll)
+		{
+			uint64_t pollUs = bus.time ();
+
+			uint32_t value = 0;
+			if (!standardRead (values [0], (uint8_t*) &value, values [1]))
+			{
+				result = false;
+				break;
+			}
+
+			printf ("  %10.3f ms: 0x%04X = %u (0x%0*X)\n", (bus.time () - startUs) / 1000.0, values [0], value,
+				(int) values [1] * 2, value);
+
+			uint64_t elapsedUs = bus.time () - pollUs;
+			if (elapsedUs < values [3] * 1000)
+				busWait (values [3] * 1000 - elapsedUs);
+		}
+		transferEnd ("poll", startUs, 0, result);
+		return result ? 0 : 1;
+	}
+
+	if (strcmp (name, "subscribe") == 0 && argumentCount >= 4)
+	{
+		*index += 5;
+		if (!parseNumber (arguments [0], MC24LC32_CAN_SUBSCRIPTION_COUNT - 1, &values [0]) ||
+			!parseNumber (arguments [1], UINT16_MAX, &values [1]) || !parseNumber (arguments [2], 4, &values [2]) ||
+			!parseNumber (arguments [3], UINT16_MAX, &values [3]))
+			return 2;
+
+		uint16_t address = values [1];
+		uint16_t period = values [3];
+		cliFrame_t command =
+		{
+			.id		= commandId,
+			.dlc	= 6,
+			.data	= { EXTENDED_INSTRUCTION (OPCODE_SUBSCRIBE, false), values [0] }
+		};
+		memcpy (command.data + 2, &address, sizeof (address));
+		memcpy (command.data + 4, &period, sizeof (period));
+
+		cliFrame_t response;
+		transferBegin (&startUs);
+		bool result = request (LATENCY_SUBSCRIBE, &command, &response, RESPONSE_TIMEOUT_US, matchExtended) &&
+			response.data [2] == MC24LC32_CAN_STATUS_OK;
+		transferEnd ("subscribe", startUs, 0, result);
+
+		if (result)
+			subscriptionSizes [values [0]] = period != 0 ? values [2] : 0;
+
+		return result ? 0 : 1;
+	}
+
+	if (strcmp (name, "listen") == 0 && argumentCount >= 1)
+	{
+		*index += 2;
+		if (!parseNumber (arguments [0], UINT32_MAX / 1000, &values [0]))
+			return 2;
+
+		uint32_t messageCount = 0;
+		uint32_t valueCount = 0;
+		transferBegin (&startUs);
+		uint64_t endUs = startUs + values [0] * 1000;
+
+		uint64_t timeUs;
+		while ((timeUs = bus.time ()) < endUs)
+		{
+			cliFrame_t frame;
+			if (!busReceive (&frame, endUs - timeUs))
+				continue;
+
+			if (!EXTENDED_IS_EXTENDED (frame.data [0]) || EXTENDED_OPCODE (frame.data [0]) != OPCODE_STREAM)
+				continue;
+
+			++messageCount;
+			printf ("  %10.3f ms:", (bus.time () - startUs) / 1000.0);
+
+			// Unpack the values of the included slots, in slot order.
+			uint8_t offset = 2;
+			for (uint8_t slot = 0; slot < MC24LC32_CAN_SUBSCRIPTION_COUNT; ++slot)
+			{
+				if ((frame.data [1] & (1u << slot)) == 0)
+					continue;
+
+				uint8_t size = subscriptionSizes [slot];
+				if (size == 0 || offset + size > frame.dlc)
+				{
+					printf (" [%u] ?", slot);
+					break;
+				}
+
+				uint32_t value = 0;
+				memcpy (&value, frame.data + offset, size);
+				offset += size;
+				++valueCount;
+				printf (" [%u] %u", slot, value);
+			}
+			printf ("\n");
+		}
+
+		transferEnd ("listen", startUs, 0, true);
+		printf ("  %u messages, %u values (%.1f messages/s)\n", messageCount, valueCount,
+			messageCount * 1000.0 / values [0]);
+		return 0;
+	}
+
+	if (strcmp (name, "wait") == 0 && argumentCount >= 1)
+	{
+		*index += 2;
+		if (!parseNumber (arguments [0], UINT32_MAX / 1000, &values [0]))
+			return 2;
+
+		busWait (values [0] * 1000);
+		return 0;
+	}
+
+	fprintf (stderr, "Invalid command '%s', or missing arguments.\n", name);
+	return 2;
+}
+
+// Entrypoint -----------------------------------------------------------------------------------------------------------------
+
+int main (int argc, char** argv)
+{
+	const char* interface = NULL;
+	const char* imagePath = NULL;
+	uint32_t value;
+
+	// Options
+	int index = 1;
+	for (; index < argc && strncmp (argv [index], "--", 2) == 0; ++index)
+	{
+		const char* option = argv [index];
+		bool hasArgument = index + 1 < argc;
+
+		if (strcmp (option, "--loopback") == 0)
+			interface = NULL;
+		else if (strcmp (option, "--socketcan") == 0 && hasArgument)
+			interface = argv [++index];
+		else if (strcmp (option, "--id") == 0 && hasArgument && parseNumber (argv [++index], 0x7FE, &value))
+			commandId = value;
+		else if (strcmp (option, "--window") == 0 && hasArgument && parseNumber (argv [++index], MC24LC32_CAN_WINDOW_MAX,
+			&value) && value != 0)
+			window = value;
+		else if (strcmp (option, "--standard") == 0)
+			standardOnly = true;
+		else if (strcmp (option, "--log") == 0 && hasArgument)
+		{
+			logFile = fopen (argv [++index], "w");
+			if (logFile == NULL)
+			{
+				fprintf (stderr, "Failed to open '%s': %s\n", argv [index], strerror (errno));
+				return 1;
+			}
+		}
+		else if (strcmp (option, "--image") == 0 && hasArgument)
+			imagePath = argv [++index];
+		else if (strcmp (option, "--bitrate") == 0 && hasArgument && parseNumber (argv [++index], 1000000, &value) &&
+			value != 0)
+			loopbackBitrate = value;
+		else if (strcmp (option, "--drop") == 0 && hasArgument && parseNumber (argv [++index], 100, &value))
+			loopbackDropRate = value;
+		else
+		{
+			printUsage (argv [0]);
+			return 2;
+		}
+	}
+
+	if (index == argc)
+	{
+		printUsage (argv [0]);
+		return 2;
+	}
+
+	if (interface != NULL ? !socketcanInit (interface) : !loopbackInit (imagePath))
+		return 1;
+
+	// Commands
+	int status = 0;
+	while (index < argc)
+	{
+		int result = runCommand (argc, argv, &index);
+		if (result == 2)
+		{
+			printUsage (argv [0]);
+			status = 2;
+			break;
+		}
+
+		if (result != 0)
+			status = 1;
+	}
+
+	// Latency statistics
+	printf ("\n%-26s %8s %8s %10s %10s %10s\n", "Request", "Count", "Failed", "Min (ms)", "Avg (ms)", "Max (ms)");
+	for (uint8_t type = 0; type < LATENCY_COUNT; ++type)
+	{
+		cliLatency_t* latency = &latencies [type];
+		if (latency->count == 0 && latency->failures == 0)
+			continue;
+
+		printf ("%-26s %8u %8u %10.3f %10.3f %10.3f\n", latency->name, latency->count, latency->failures,
+			latency->minUs / 1000.0, latency->count != 0 ? latency->totalUs / 1000.0 / latency->count : 0.0,
+			latency->maxUs / 1000.0);
+	}
+
+	if (interface == NULL)
+		loopbackDeinit (imagePath);
+
+	if (logFile != NULL)
+		fclose (logFile);
+
+	return status;
+}
\ No newline at end of file
@@ -0,0 +1,159 @@
+// Header
+#include "mc24lc32_sim.h"
+
+// C Standard Library
+#include <string.h>
+
+// Function Prototypes --------------------------------------------------------------------------------------------------------
+
+void mc24lc32SimWrite (mc24lc32Sim_t* sim, const uint8_t* data, size_t dataCount);
+
+void mc24lc32SimRead (mc24lc32Sim_t* sim, uint8_t* data, size_t dataCount);
+
+uint32_t mc24lc32SimRandom (mc24lc32Sim_t* sim);
+
+// Functions ------------------------------------------------------------------------------------------------------------------
+
+void mc24lc32SimInit (mc24lc32Sim_t* sim, I2CDriver* i2c, uint8_t addr)
+{
+	memset (sim->memory, 0xFF, sizeof (sim->memory));
+	sim->addr = addr;
+	sim->writeCycleTime = TIME_MS2I (5);
+	sim->seed = 1;
+	mc24lc32SimPowerCycle (sim);
+	mc24lc32SimResetStatistics (sim);
+
+	i2c->transfer = mc24lc32SimTransfer;
+	i2c->device = sim;
+}
+
+msg_t mc24lc32SimTransfer (void* device, i2caddr_t addr, const uint8_t* tx, size_t txCount, uint8_t* rx, size_t rxCount)
+{
+	mc24lc32Sim_t* sim = (mc24lc32Sim_t*) device;
+
+	// Complete the write cycle, if it has elapsed.
+	if (sim->writeCycleActive && (int32_t) chTimeDiffX (sim->writeCycleEnd, chVTGetSystemTime ()) >= 0)
+		sim->writeCycleActive = false;
+
+	// The device does not acknowledge while unpowered, busy or addressed incorrectly.
+	if (!sim->powered || sim->writeCycleActive || addr != sim->addr)
+	{
+		++sim->nackCount;
+		return MSG_RESET;
+	}
+
+	// Transfers start with the address (big-endian), the high 4 bits are ignored.
+	if (txCount >= 2)
+		sim->addressPointer = ((tx [0] << 8) | tx [1]) % MC24LC32_SIM_SIZE;
+
+	// Any following bytes are a page write (see datasheet Section 6.2). A transfer of only the address does not start a
+	// write cycle, this is how acknowledge polling and random reads are performed.
+	if (txCount > 2)
+		mc24lc32SimWrite (sim, tx + 2, txCount - 2);
+
+	// Reads start from the address pointer (see datasheet Section 8.0).
+	if (rxCount > 0)
+		mc24lc32SimRead (sim, rx, rxCount);
+
+	return MSG_OK;
+}
+
+void mc24lc32SimResetStatistics (mc24lc32Sim_t* sim)
+{
+	sim->pageWriteCount = 0;
+	memset (sim->pageWriteCounts, 0, sizeof (sim->pageWriteCounts));
+	sim->readByteCount = 0;
+	sim->nackCount = 0;
+}
+
+/// @brief Performs a page write at the address pointer. Bytes past the end of the page wrap around to its beginning.
+void mc24lc32SimWrite (mc24lc32Sim_t* sim, const uint8_t* data, size_t dataCount)
+{
+	uint16_t page = sim->addressPointer / MC24LC32_SIM_PAGE_SIZE;
+	uint16_t pageAddress = page * MC24LC32_SIM_PAGE_SIZE;
+	uint16_t offset = sim->addressPointer % MC24LC32_SIM_PAGE_SIZE;
+
+	bool powerLoss = sim->powerLossCountdown == 0;
+
+	for (size_t index = 0; index < dataCount; ++index)
+	{
+		uint8_t* byte = sim->memory + pageAddress + (offset + index) % MC24LC32_SIM_PAGE_SIZE;
+
+		if (!powerLoss)
+		{
+			*byte = data [index];
+			continue;
+		}
+
+		// The write cycle is interrupted, the byte may be in any state.
+		switch (mc24lc32SimRandom (sim) % 3)
+		{
+		case 0:
+			break;
+		case 1:
+			*byte = data [index];
+			break;
+		default:
+			*byte = 0xFF;
+			break;
+		}
+	}
+
+	sim->addressPointer = pageAddress + (offset + dataCount) % MC24LC32_SIM_PAGE_SIZE;
+
+	if (powerLoss)
+	{
+		sim->powered = false;
+		sim->powerLossCountdown = -1;
+		return;
+	}
+
+	if (sim->powerLossCountdown > 0)
+		--sim->powerLossCountdown;
+
+	++sim->pageWriteCount;
+	++sim->pageWriteCounts [page];
+
+	sim->writeCycleActive = true;
+	sim->writeCycleEnd = chVTGetSystemTime () + sim->writeCycleTime;
+}
+
+/// @brief Performs a sequential read from the address pointer. Reads past the end of the memory wrap around to its
+/// beginning.
+void mc24lc32SimRead (mc24lc32Sim_t* sim, uint8_t* data, size_t dataCount)
+{
+	for (size_t index = 0; index < dataCount; ++index)
+	{
+		data [index] = sim->memory [sim->addressPointer];
+		sim->addressPointer = (sim->addressPointer + 1) % MC24LC32_SIM_SIZE;
+	}
+
+	sim->readByteCount += dataCount;
+}
+
+/// @brief Generates a pseudo-random number (xorshift32).
+uint32_t mc24lc32SimRandom (mc24lc32Sim_t* sim)
+{
+	sim->seed ^= sim->seed << 13;
+	sim->seed ^= sim->seed >> 17;
+	sim->seed ^= sim->seed << 5;
+	return sim->seed;
+}
+
+// Power Loss -----------------------------------------------------------------------------------------------------------------
+
+void mc24lc32SimSchedulePowerLoss (mc24lc32Sim_t* sim, uint32_t pageWriteCount, uint32_t seed)
+{
+	sim->powerLossCountdown = (int32_t) pageWriteCount;
+
+	// Note the generator must not be seeded with 0.
+	sim->seed = seed != 0 ? seed : 1;
+}
+
+void mc24lc32SimPowerCycle (mc24lc32Sim_t* sim)
+{
+	sim->powered = true;
+	sim->powerLossCountdown = -1;
+	sim->addressPointer = 0;
+	sim->writeCycleActive = false;
+}
\ No newline at end of file
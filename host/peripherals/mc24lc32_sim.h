@@ -0,0 +1,118 @@
+#ifndef MC24LC32_SIM_H
+#define MC24LC32_SIM_H
+
+// MC24LC32 Simulator ---------------------------------------------------------------------------------------------------------
+//
+// Author: agent
+// Date Created: 2026.10.17
+//
+// Description: Host-side model of the Microchip 24LC32 I2C EEPROM, for running the mc24lc32 driver (and the modules built on
+//   top of it) against the ChibiOS host shim. The model follows the datasheet's bus-level behavior:
+//   - The high 4 bits of the address are ignored.
+//   - Page writes wrap around to the beginning of the page, rather than crossing into the next one.
+//   - Sequential reads wrap around from the end of the memory to the beginning.
+//   - The device does not acknowledge its address during the internal write cycle (tWC), which is timed using the virtual
+//     clock.
+//
+//   A power loss can be scheduled to occur during a specific page write. Each byte of the interrupted write is left as its
+//   old value, its new value or erased, pseudo-randomly, after which the device does not respond until it is power cycled.
+
+// Includes -------------------------------------------------------------------------------------------------------------------
+
+// ChibiOS (host shim)
+#include "hal.h"
+
+// Constants ------------------------------------------------------------------------------------------------------------------
+
+/// @brief Memory size of the device in bytes.
+#define MC24LC32_SIM_SIZE 4096
+
+/// @brief Size of a page of the device in bytes.
+#define MC24LC32_SIM_PAGE_SIZE 32
+
+/// @brief Number of pages in the device.
+#define MC24LC32_SIM_PAGE_COUNT (MC24LC32_SIM_SIZE / MC24LC32_SIM_PAGE_SIZE)
+
+// Datatypes ------------------------------------------------------------------------------------------------------------------
+
+typedef struct
+{
+	/// @brief The contents of the device's memory.
+	uint8_t memory [MC24LC32_SIM_SIZE];
+
+	/// @brief The 7-bit I2C address of the device.
+	uint8_t addr;
+
+	/// @brief The device's internal address pointer, used by reads.
+	uint16_t addressPointer;
+
+	/// @brief The duration of the device's internal write cycle. Defaults to the datasheet's maximum of 5 ms.
+	sysinterval_t writeCycleTime;
+
+	/// @brief The time the current write cycle ends at, only applicable if @c writeCycleActive is set.
+	systime_t writeCycleEnd;
+
+	/// @brief Indicates the device is busy with a write cycle.
+	bool writeCycleActive;
+
+	/// @brief Indicates the device is powered. While unpowered, the device does not respond to anything.
+	bool powered;
+
+	/// @brief Number of page writes to complete before the power is lost, or -1 if no power loss is scheduled.
+	int32_t powerLossCountdown;
+
+	/// @brief State of the pseudo-random generator used to corrupt interrupted writes.
+	uint32_t seed;
+
+	/// @brief The total number of page writes performed.
+	uint32_t pageWriteCount;
+
+	/// @brief The number of page writes performed to each page, for evaluating wear.
+	uint32_t pageWriteCounts [MC24LC32_SIM_PAGE_COUNT];
+
+	/// @brief The total number of bytes read.
+	uint32_t readByteCount;
+
+	/// @brief The total number of transfers that were not acknowledged.
+	uint32_t nackCount;
+} mc24lc32Sim_t;
+
+// Functions ------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Initializes a simulated device, in the erased state (all 1's), and attaches it to a bus.
+ * @param sim The device to initialize.
+ * @param i2c The bus to attach the device to.
+ * @param addr The 7-bit I2C address of the device.
+ */
+void mc24lc32SimInit (mc24lc32Sim_t* sim, I2CDriver* i2c, uint8_t addr);
+
+/**
+ * @brief Performs a transfer with the device. See @c hostI2cTransfer_t for details.
+ */
+msg_t mc24lc32SimTransfer (void* device, i2caddr_t addr, const uint8_t* tx, size_t txCount, uint8_t* rx, size_t rxCount);
+
+/**
+ * @brief Resets the device's statistics.
+ * @param sim The device to reset.
+ */
+void mc24lc32SimResetStatistics (mc24lc32Sim_t* sim);
+
+// Power Loss -----------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Schedules a power loss. The power is lost during the page write following the specified number of successful page
+ * writes.
+ * @param sim The device to schedule the power loss of.
+ * @param pageWriteCount The number of page writes to complete before the power loss.
+ * @param seed The seed used to determine the contents of the interrupted page write.
+ */
+void mc24lc32SimSchedulePowerLoss (mc24lc32Sim_t* sim, uint32_t pageWriteCount, uint32_t seed);
+
+/**
+ * @brief Restores the device's power, cancelling any scheduled power loss. The device's volatile state is reset.
+ * @param sim The device to power cycle.
+ */
+void mc24lc32SimPowerCycle (mc24lc32Sim_t* sim);
+
+#endif // MC24LC32_SIM_H
\ No newline at end of file
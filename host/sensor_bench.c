@@ -0,0 +1,286 @@
+// Sensor Benchmark -----------------------------------------------------------------------------------------------------------
+//
+// Author: agent
+// Date Created: 2026.10.17
+//
+// Description: Checks the sensor objects against known samples on the host. The segment search of the table sensor is
+//   checked for uniformly and non-uniformly spaced tables, at exact points, between points, at the ends of the table and
+//   outside of it, with the segment hint both near and far from the sample. The redundant sensor pair is stepped through
+//   the virtual clock, checking its transitions across the disagreement window and the hysteresis.
+//
+// Usage: sensor_bench
+
+// Includes
+#include "peripherals/sensor_pair.h"
+#include "peripherals/table_sensor.h"
+
+// C Standard Library
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Constants ------------------------------------------------------------------------------------------------------------------
+
+/// @brief The tolerance of interpolated values.
+#define VALUE_TOLERANCE 1e-4f
+
+// Table Sensor ---------------------------------------------------------------------------------------------------------------
+
+static const adcsample_t TABLE_SAMPLES [] = { 100, 200, 400, 800, 1600, 3200 };
+static const float TABLE_VALUES [] = { -40.0f, -20.0f, 0.0f, 25.0f, 60.0f, 120.0f };
+
+/// @brief Non-uniformly spaced table.
+static const tableSensorConfig_t TABLE_CONFIG =
+{
+	.samples	= TABLE_SAMPLES,
+	.values		= TABLE_VALUES,
+	.pointCount	= sizeof (TABLE_SAMPLES) / sizeof (TABLE_SAMPLES [0])
+};
+
+/// @brief Uniformly spaced table, points at 1000, 1500, ..., 3500.
+static const tableSensorConfig_t TABLE_UNIFORM_CONFIG =
+{
+	.samples	= NULL,
+	.values		= TABLE_VALUES,
+	.pointCount	= sizeof (TABLE_VALUES) / sizeof (TABLE_VALUES [0]),
+	.sampleMin	= 1000,
+	.sampleStep	= 500
+};
+
+/// @brief A table's sample and the expected value, @c NAN if the sample is outside of the table.
+typedef struct
+{
+	adcsample_t sample;
+	float value;
+} tableCase_t;
+
+// Sensor Pair ----------------------------------------------------------------------------------------------------------------
+
+/// @brief Samples of 0 to 4000 mapping to 0 to 100%, 40 samples per %.
+static linearSensorConfig_t pairSensorConfig =
+{
+	.sampleMin	= 0,
+	.sampleMax	= 4000,
+	.valueMin	= 0.0f,
+	.valueMax	= 100.0f
+};
+
+/// @brief A step of a sensor pair: the time to advance by, the sensors' samples and the expected state and value.
+typedef struct
+{
+	sysinterval_t advance;
+	adcsample_t sampleA;
+	adcsample_t sampleB;
+	sensorPairState_t state;
+	float value;
+} pairCase_t;
+
+// Function Prototypes --------------------------------------------------------------------------------------------------------
+
+void checkEnd (const char* name, bool result);
+
+bool tableCheck (const tableSensorConfig_t* config, const tableCase_t* cases, uint16_t caseCount);
+
+bool pairCheck (const pairCase_t* cases, uint16_t caseCount, uint32_t implausibleCount);
+
+// Checks ---------------------------------------------------------------------------------------------------------------------
+
+/// @brief The number of checks that failed.
+static uint32_t checkFailureCount = 0;
+
+void checkEnd (const char* name, bool result)
+{
+	if (!result)
+		++checkFailureCount;
+
+	printf ("%-48s %s\n", name, result ? "ok" : "FAIL");
+}
+
+/// @brief Updates a sensor with each sample in order (such that the segment hint carries over), checking its state and
+/// value.
+bool tableCheck (const tableSensorConfig_t* config, const tableCase_t* cases, uint16_t caseCount)
+{
+	tableSensor_t sensor;
+	if (!tableSensorInit (&sensor, config))
+		return false;
+
+	bool result = true;
+	for (uint16_t index = 0; index < caseCount; ++index)
+	{
+		tableSensorUpdate (&sensor, cases [index].sample);
+
+		bool valid = !isnan (cases [index].value);
+		bool pass = valid ?
+			sensor.state == TABLE_SENSOR_VALID && fabsf (sensor.value - cases [index].value) <= VALUE_TOLERANCE :
+			sensor.state == TABLE_SENSOR_VALUE_INVALID && sensor.value == 0.0f;
+
+		if (!pass)
+		{
+			printf ("  Sample %u: state %u, value %f, expected %f\n", cases [index].sample, sensor.state, sensor.value,
+				cases [index].value);
+			result = false;
+		}
+	}
+
+	return result;
+}
+
+/// @brief Steps a pair (tolerance 10%, hysteresis 4%, window 100 ms) through each case in order, checking its state and
+/// value after each step, and the number of times it became implausible at the end.
+bool pairCheck (const pairCase_t* cases, uint16_t caseCount, uint32_t implausibleCount)
+{
+	linearSensor_t sensorA;
+	linearSensor_t sensorB;
+	if (!linearSensorInit (&sensorA, &pairSensorConfig) || !linearSensorInit (&sensorB, &pairSensorConfig))
+		return false;
+
+	sensorPairConfig_t config =
+	{
+		.sensorA	= &sensorA,
+		.sensorB	= &sensorB,
+		.tolerance	= 10.0f,
+		.hysteresis	= 4.0f,
+		.window		= TIME_MS2I (100)
+	};
+
+	sensorPair_t pair;
+	if (!sensorPairInit (&pair, &config))
+		return false;
+
+	bool result = true;
+	for (uint16_t index = 0; index < caseCount; ++index)
+	{
+		hostClockAdvance (cases [index].advance);
+		sensorPairUpdateA (&pair, cases [index].sampleA);
+		sensorPairUpdateB (&pair, cases [index].sampleB);
+
+		if (pair.state != cases [index].state || fabsf (pair.value - cases [index].value) > VALUE_TOLERANCE)
+		{
+			printf ("  Step %u: state %u, value %f, expected state %u, value %f\n", index, pair.state, pair.value,
+				cases [index].state, cases [index].value);
+			result = false;
+		}
+	}
+
+	if (pair.implausibleCount != implausibleCount)
+	{
+		printf ("  Implausible count %lu, expected %lu\n", (unsigned long) pair.implausibleCount,
+			(unsigned long) implausibleCount);
+		result = false;
+	}
+
+	return result;
+}
+
+// Entrypoint -----------------------------------------------------------------------------------------------------------------
+
+int main (void)
+{
+	printf ("Table sensor:\n");
+
+	// Every point of the table, ascending then descending (the hint moving to a neighbour each time).
+	const tableCase_t points [] =
+	{
+		{ 100, -40.0f }, { 200, -20.0f }, { 400, 0.0f }, { 800, 25.0f }, { 1600, 60.0f }, { 3200, 120.0f },
+		{ 1600, 60.0f }, { 800, 25.0f }, { 400, 0.0f }, { 200, -20.0f }, { 100, -40.0f }
+	};
+	checkEnd ("Exact points (hint neighbours)", tableCheck (&TABLE_CONFIG, points, sizeof (points) / sizeof (points [0])));
+
+	// Jumps across the table, requiring the binary search, including the last point from the first segment.
+	const tableCase_t jumps [] =
+	{
+		{ 150, -30.0f }, { 3200, 120.0f }, { 100, -40.0f }, { 2400, 90.0f }, { 300, -10.0f }, { 1200, 42.5f },
+		{ 101, -39.8f }, { 3199, 119.9625f }
+	};
+	checkEnd ("Between points (binary search)", tableCheck (&TABLE_CONFIG, jumps, sizeof (jumps) / sizeof (jumps [0])));
+
+	// Samples outside of the table are invalid, and do not disturb the hint.
+	const tableCase_t outside [] =
+	{
+		{ 99, NAN }, { 0, NAN }, { 3201, NAN }, { UINT16_MAX, NAN }, { 600, 12.5f }, { 3201, NAN }, { 700, 18.75f }
+	};
+	checkEnd ("Outside of the table", tableCheck (&TABLE_CONFIG, outside, sizeof (outside) / sizeof (outside [0])));
+
+	// Uniform spacing: points, the last point (belonging to the last segment), between points and outside of the table.
+	const tableCase_t uniform [] =
+	{
+		{ 1000, -40.0f }, { 1500, -20.0f }, { 3500, 120.0f }, { 3499, 119.88f }, { 1250, -30.0f }, { 2750, 42.5f },
+		{ 999, NAN }, { 3501, NAN }
+	};
+	checkEnd ("Uniform spacing", tableCheck (&TABLE_UNIFORM_CONFIG, uniform, sizeof (uniform) / sizeof (uniform [0])));
+
+	// Invalid configurations.
+	const adcsample_t unsorted [] = { 100, 300, 200 };
+	const tableSensorConfig_t unsortedConfig = { .samples = unsorted, .values = TABLE_VALUES, .pointCount = 3 };
+	const tableSensorConfig_t singleConfig = { .samples = TABLE_SAMPLES, .values = TABLE_VALUES, .pointCount = 1 };
+	const tableSensorConfig_t overflowConfig =
+		{ .values = TABLE_VALUES, .pointCount = 6, .sampleMin = 60000, .sampleStep = 2000 };
+	tableSensor_t sensor;
+	checkEnd ("Invalid configurations (rejected)", !tableSensorInit (&sensor, &unsortedConfig) &&
+		!tableSensorInit (&sensor, &singleConfig) && !tableSensorInit (&sensor, &overflowConfig));
+
+	printf ("\nSensor pair:\n");
+
+	// Starts implausible until the sensors first agree. A difference at the tolerance is plausible.
+	const pairCase_t agreement [] =
+	{
+		{ 0, 2000, 3000, SENSOR_PAIR_IMPLAUSIBLE, 0.0f },
+		{ TIME_MS2I (1), 2000, 2000, SENSOR_PAIR_PLAUSIBLE, 50.0f },
+		{ TIME_MS2I (1), 2000, 2400, SENSOR_PAIR_PLAUSIBLE, 55.0f },
+		{ TIME_MS2I (1), 2400, 2000, SENSOR_PAIR_PLAUSIBLE, 55.0f }
+	};
+	checkEnd ("Plausible", pairCheck (agreement, sizeof (agreement) / sizeof (agreement [0]), 0));
+
+	// A disagreement holds the last plausible value for the window (inclusive), then becomes implausible.
+	const pairCase_t window [] =
+	{
+		{ 0, 2000, 2000, SENSOR_PAIR_PLAUSIBLE, 50.0f },
+		{ TIME_MS2I (1), 2000, 2401, SENSOR_PAIR_PENDING, 50.0f },
+		{ TIME_MS2I (50), 2000, 2800, SENSOR_PAIR_PENDING, 50.0f },
+		{ TIME_MS2I (50), 2000, 2800, SENSOR_PAIR_PENDING, 50.0f },
+		{ TIME_US2I (1), 2000, 2800, SENSOR_PAIR_IMPLAUSIBLE, 0.0f },
+		{ TIME_MS2I (500), 2000, 2800, SENSOR_PAIR_IMPLAUSIBLE, 0.0f }
+	};
+	checkEnd ("Pending, then implausible after the window", pairCheck (window, sizeof (window) / sizeof (window [0]), 1));
+
+	// A disagreement ending within the window recovers at the tolerance, the next one restarting the window.
+	const pairCase_t pending [] =
+	{
+		{ 0, 2000, 2000, SENSOR_PAIR_PLAUSIBLE, 50.0f },
+		{ TIME_MS2I (1), 2000, 2800, SENSOR_PAIR_PENDING, 50.0f },
+		{ TIME_MS2I (90), 2000, 2400, SENSOR_PAIR_PLAUSIBLE, 55.0f },
+		{ TIME_MS2I (1), 2000, 2800, SENSOR_PAIR_PENDING, 55.0f },
+		{ TIME_MS2I (90), 2000, 2800, SENSOR_PAIR_PENDING, 55.0f },
+		{ TIME_MS2I (10), 2000, 2800, SENSOR_PAIR_PENDING, 55.0f },
+		{ TIME_MS2I (1), 2000, 2800, SENSOR_PAIR_IMPLAUSIBLE, 0.0f }
+	};
+	checkEnd ("Pending, then recovered", pairCheck (pending, sizeof (pending) / sizeof (pending [0]), 1));
+
+	// Once implausible, the difference must fall to the tolerance less the hysteresis (6%) to recover.
+	const pairCase_t hysteresis [] =
+	{
+		{ 0, 2000, 2000, SENSOR_PAIR_PLAUSIBLE, 50.0f },
+		{ TIME_MS2I (1), 2000, 2800, SENSOR_PAIR_PENDING, 50.0f },
+		{ TIME_MS2I (101), 2000, 2800, SENSOR_PAIR_IMPLAUSIBLE, 0.0f },
+		{ TIME_MS2I (1), 2000, 2400, SENSOR_PAIR_IMPLAUSIBLE, 0.0f },
+		{ TIME_MS2I (1), 2000, 2241, SENSOR_PAIR_IMPLAUSIBLE, 0.0f },
+		{ TIME_MS2I (1), 2000, 2240, SENSOR_PAIR_PLAUSIBLE, 53.0f },
+		{ TIME_MS2I (1), 2000, 2400, SENSOR_PAIR_PLAUSIBLE, 55.0f },
+		{ TIME_MS2I (1), 2000, 2800, SENSOR_PAIR_PENDING, 55.0f },
+		{ TIME_MS2I (101), 2000, 2800, SENSOR_PAIR_IMPLAUSIBLE, 0.0f }
+	};
+	checkEnd ("Implausible, then recovered (hysteresis)",
+		pairCheck (hysteresis, sizeof (hysteresis) / sizeof (hysteresis [0]), 2));
+
+	// An invalid sensor is a disagreement.
+	const pairCase_t invalid [] =
+	{
+		{ 0, 2000, 2000, SENSOR_PAIR_PLAUSIBLE, 50.0f },
+		{ TIME_MS2I (1), 2000, 4001, SENSOR_PAIR_PENDING, 50.0f },
+		{ TIME_MS2I (101), 2000, 4001, SENSOR_PAIR_IMPLAUSIBLE, 0.0f }
+	};
+	checkEnd ("Invalid sensor", pairCheck (invalid, sizeof (invalid) / sizeof (invalid [0]), 1));
+
+	printf ("\n%s\n", checkFailureCount == 0 ? "All sensor checks passed." : "Sensor checks FAILED.");
+	return checkFailureCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
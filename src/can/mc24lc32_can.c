@@ -1,6 +1,10 @@
 // Header
 #include "mc24lc32_can.h"
 
+// Includes
+#include "mc24lc32_can_protocol.h"
+#include "peripherals/crc32.h"
+
 // C Standard Library
 #include <string.h>
 
@@ -22,21 +26,84 @@
 
 #define RESPONSE_TIMEOUT TIME_MS2I (100)
 
+/// @brief Timeout of each frame of a block transfer. Shorter than the response timeout, as a frame that cannot be sent is
+/// recovered by the receiver requesting its retransmission.
+#define BLOCK_TIMEOUT TIME_MS2I (10)
+
+/// @brief Period of inactivity after which a transaction is aborted, such that a host disconnecting mid-transaction does not
+/// leave the node deferring writes indefinitely.
+#define TRANSACTION_TIMEOUT TIME_S2I (10)
+
+/// @brief Timeout of each stream message. Streamed values are periodic, so a message that cannot be sent is dropped.
+#define STREAM_TIMEOUT TIME_MS2I (1)
+
+// Transactions ---------------------------------------------------------------------------------------------------------------
+
+/// @brief Checks whether a byte is staged by the transaction in progress.
+#define BYTE_IS_STAGED(can, address) (((can)->transactionBytes [(address) / 8] & (1u << ((address) % 8))) != 0)
+
 // Global Constants -----------------------------------------------------------------------------------------------------------
 
 static const uint32_t INVALID_READ_DATA = 0xFFFFFFFF;
 
 // Function Prototypes --------------------------------------------------------------------------------------------------------
 
+void handleStandardCommand (CANRxFrame* frame, CANDriver* driver, mc24lc32_t* eeprom,
+	mc24lc32ReadonlyCallback_t readonlyCallback, mc24lc32Can_t* can);
+
+void handleTransaction (mc24lc32Can_t* can, CANRxFrame* frame);
+
+bool commitTransaction (mc24lc32Can_t* can);
+
+void abortTransaction (mc24lc32Can_t* can);
+
+void transactionRead (mc24lc32Can_t* can, uint16_t address, uint8_t* data, uint16_t count);
+
+void transactionWrite (mc24lc32Can_t* can, uint16_t address, const uint8_t* data, uint16_t count);
+
+msg_t transmitTransactionResponse (CANDriver* driver, uint16_t id, uint8_t action, mc24lc32CanStatus_t status);
+
+void handleSubscribe (mc24lc32Can_t* can, CANRxFrame* frame);
+
+msg_t transmitSubscribeResponse (CANDriver* driver, uint16_t id, uint8_t slot, mc24lc32CanStatus_t status);
+
+msg_t transmitStream (mc24lc32Can_t* can, uint8_t slotMask, const uint8_t* data, uint8_t dataCount);
+
 msg_t transmitDataResponse (CANDriver* driver, sysinterval_t timeout, uint16_t id, uint16_t address, const void* data,
 	uint8_t dataCount);
 
 msg_t transmitValidationResponse (CANDriver* driver, sysinterval_t timeout, uint16_t id, bool isValid);
 
+void handleBlockStart (mc24lc32Can_t* can, CANRxFrame* frame, bool readNotWrite);
+
+void handleBlockData (mc24lc32Can_t* can, CANRxFrame* frame);
+
+void handleBlockAck (mc24lc32Can_t* can, CANRxFrame* frame);
+
+void handleBlockEnd (mc24lc32Can_t* can, CANRxFrame* frame);
+
+void abortBlock (mc24lc32Can_t* can);
+
+void transmitBlockWindow (mc24lc32Can_t* can, bool retransmit);
+
+msg_t transmitBlockData (mc24lc32Can_t* can, uint16_t frameIndex);
+
+msg_t transmitBlockAck (mc24lc32Can_t* can, uint16_t frameIndex, bool retransmit);
+
+msg_t transmitBlockEnd (mc24lc32Can_t* can, mc24lc32CanStatus_t status, uint32_t crc);
+
 // Functions ------------------------------------------------------------------------------------------------------------------
 
 void mc24lc32HandleCanCommand (CANRxFrame* frame, CANDriver* driver, mc24lc32_t* eeprom,
 	mc24lc32ReadonlyCallback_t readonlyCallback)
+{
+	handleStandardCommand (frame, driver, eeprom, readonlyCallback, NULL);
+}
+
+/// @brief Handles a standard command. If @c can is not @c NULL and has a transaction in progress, reads / writes are of the
+/// transaction's staged memory, writes being committed by the end of the transaction.
+void handleStandardCommand (CANRxFrame* frame, CANDriver* driver, mc24lc32_t* eeprom,
+	mc24lc32ReadonlyCallback_t readonlyCallback, mc24lc32Can_t* can)
 {
 	// EEPROM Command Message:
 	//   Bytes 0 to 1: Instruction
@@ -48,6 +115,11 @@ void mc24lc32HandleCanCommand (CANRxFrame* frame, CANDriver* driver, mc24lc32_t*
 	//   Bytes 4 to 7: (Data only) Data
 
 	uint16_t responseId = frame->SID + 1;
+	bool transaction = can != NULL && can->transaction;
+
+	// Extended commands require the stateful handler.
+	if (EXTENDED_IS_EXTENDED (frame->data8 [0]))
+		return;
 
 	bool readNotWrite = COMMAND_READ_NOT_WRITE (frame->data16 [0]);
 	bool dataNotValidation = COMMAND_DATA_NOT_VALIDATION (frame->data16 [0]);
@@ -66,6 +138,23 @@ void mc24lc32HandleCanCommand (CANRxFrame* frame, CANDriver* driver, mc24lc32_t*
 			bool isValid = COMMAND_IS_VALID (frame->data16 [0]);
 
 			// Validate / invalidate the EEPROM for next boot.
+			if (transaction)
+			{
+				// Stage the magic string (including terminator), or all 1's over it.
+				uint8_t stringSize = strlen (eeprom->magicString) + 1;
+				uint8_t data [MC24LC32_PAGE_SIZE];
+				if (stringSize > sizeof (data))
+					return;
+
+				if (isValid)
+					memcpy (data, eeprom->magicString, stringSize);
+				else
+					memset (data, 0xFF, stringSize);
+
+				transactionWrite (can, 0, data, stringSize);
+				return;
+			}
+
 			if (isValid)
 				mc24lc32Validate (eeprom);
 			else
@@ -86,11 +175,24 @@ void mc24lc32HandleCanCommand (CANRxFrame* frame, CANDriver* driver, mc24lc32_t*
 				// Readonly variable read
 				void* data = NULL;
 				uint8_t dataCount;
-				if (readonlyCallback != NULL && readonlyCallback (address, &data, &dataCount))
+				if (readonlyCallback != NULL && readonlyCallback (address, &data, &dataCount) && dataCount != 0 &&
+					dataCount <= MC24LC32_CAN_VARIABLE_SIZE_MAX)
 					transmitDataResponse (driver, RESPONSE_TIMEOUT, responseId, address, data, dataCount);
 				else
 					transmitDataResponse (driver, RESPONSE_TIMEOUT, responseId, address, &INVALID_READ_DATA, 4);
 			}
+			else if (address + dataCount > MC24LC32_DATA_SIZE)
+			{
+				// Addresses past the end of the cache are not accessible
+				transmitDataResponse (driver, RESPONSE_TIMEOUT, responseId, address, &INVALID_READ_DATA, dataCount);
+			}
+			else if (transaction)
+			{
+				// Data read, including the transaction's modifications
+				uint8_t data [4];
+				transactionRead (can, address, data, dataCount);
+				transmitDataResponse (driver, RESPONSE_TIMEOUT, responseId, address, data, dataCount);
+			}
 			else
 			{
 				// Data read
@@ -102,11 +204,647 @@ void mc24lc32HandleCanCommand (CANRxFrame* frame, CANDriver* driver, mc24lc32_t*
 		else
 		{
 			// Data write
-			// Write the changes to the EEPROM.
+			// Write the changes to the EEPROM, ignoring anything outside of the cache.
 			uint8_t* data = frame->data8 + 4;
-			mc24lc32WriteThrough (eeprom, address, data, dataCount);
+			if (address + dataCount > MC24LC32_DATA_SIZE)
+				return;
+
+			if (transaction)
+				transactionWrite (can, address, data, dataCount);
+			else
+				mc24lc32WriteThrough (eeprom, address, data, dataCount);
+		}
+	}
+}
+
+bool mc24lc32CanInit (mc24lc32Can_t* can, const mc24lc32CanConfig_t* config)
+{
+	// Store the configuration
+	can->driver				= config->driver;
+	can->eeprom				= config->eeprom;
+	can->readonlyCallback	= config->readonlyCallback;
+
+	can->variables			= config->variables;
+	can->variableCount		= config->variableCount;
+
+	// Validate the registry, a variable larger than a response's data would overrun the response and stream buffers.
+	bool registryValid = true;
+	for (uint16_t index = 0; index < can->variableCount; ++index)
+	{
+		const mc24lc32CanVariable_t* variable = &can->variables [index];
+		if (variable->size == 0 || variable->size > MC24LC32_CAN_VARIABLE_SIZE_MAX || variable->address < MC24LC32_SIZE ||
+			(index != 0 && variable->address <= can->variables [index - 1].address))
+			registryValid = false;
+	}
+
+	if (!registryValid)
+	{
+		can->variables = NULL;
+		can->variableCount = 0;
+	}
+
+	can->blockState = MC24LC32_CAN_BLOCK_IDLE;
+	can->transaction = false;
+	memset (can->transactionBytes, 0, sizeof (can->transactionBytes));
+
+	for (uint8_t slot = 0; slot < MC24LC32_CAN_SUBSCRIPTION_COUNT; ++slot)
+		can->subscriptions [slot].variable = NULL;
+
+	chMtxObjectInit (&can->mutex);
+
+	return registryValid;
+}
+
+void mc24lc32CanHandleCommand (mc24lc32Can_t* can, CANRxFrame* frame)
+{
+	// EEPROM Extended Command Message:
+	//   Byte 0: Instruction
+	//     Bits 0 to 1: Always set (older handlers treat the message as a data read)
+	//     Bit 2: (Block acknowledgement only) Retransmit
+	//     Bit 4: Extended (always set)
+	//     Bits 5 to 7: Opcode
+	//       0: Block read (start), 1: Block write (start), 2: Block data, 3: Block acknowledgement, 4: Block end
+	//   Byte 1:
+	//     (Block read / write) Window size, in frames
+	//     (Block data / acknowledgement) Sequence number, the frame index modulo 256. Acknowledgements carry the index of the
+	//       next frame expected, meaning all prior frames were received.
+	//     (Block end response) Status, see mc24lc32CanStatus_t
+	//   Bytes 2 to 3: (Block read / write only) Address
+	//   Bytes 4 to 5: (Block read / write only) Data count
+	//   Bytes 2 to 7: (Block data only) Data
+	//   Bytes 2 to 5: (Block end only) CRC of the range
+	//
+	// Block read: The host sends a block read, the node responds with data frames, up to a window ahead of the host's
+	//   acknowledgements, followed by a block end once the last frame is sent. The host acknowledges the final frame to end
+	//   the transfer.
+	// Block write: The host sends a block write, the node acknowledges frame 0 once ready. The host sends data frames, up to
+	//   a window ahead of the node's acknowledgements, followed by a block end. The node commits the range if its CRC
+	//   matches, then responds with a block end indicating the status.
+	// Recovery: The node requests a retransmission once per gap in the sequence. If the host does not receive an
+	//   acknowledgement in time, it sends (or repeats) the block end, to which the node always responds, either with a
+	//   retransmission request from the first missing frame or, if the write was completed, with the status.
+	//   Likewise, during a block read, the host requests a retransmission if it does not receive a frame in time.
+	//
+	// Transaction: Byte 1 indicates the action (0: Begin, 1: Commit, 2: Abort), each of which is responded to with the
+	//   action in byte 1 and its status in byte 2. Between the begin and the commit, writes (standard, validation or block)
+	//   are staged, reads returning the staged data. The commit then writes each modified page once. An abort, or a
+	//   transaction left inactive for 10 seconds, discards the transaction's modifications.
+	//
+	// Subscribe: Byte 1 indicates the slot (0 to 7), bytes 2 to 3 the address of a registered variable and bytes 4 to 5 the
+	//   period in milliseconds (0 to unsubscribe). Responded to with the slot in byte 1 and the status in byte 2. Stream
+	//   messages are transmitted with the response ID of the last subscribe command.
+	//
+	// EEPROM Stream Message:
+	//   Byte 0: Instruction (extended, opcode 7)
+	//   Byte 1: Bitmask of the slots whose values are included
+	//   Bytes 2 to 7: The values of the included slots, in slot order
+
+	// Abort a transaction the host has abandoned
+	if (can->transaction && chTimeDiffX (can->transactionTime, chVTGetSystemTime ()) >= TRANSACTION_TIMEOUT)
+		abortTransaction (can);
+
+	if (can->transaction)
+		can->transactionTime = chVTGetSystemTime ();
+
+	// Readonly variable reads are looked up in the registry first
+	if (!EXTENDED_IS_EXTENDED (frame->data8 [0]) && COMMAND_READ_NOT_WRITE (frame->data16 [0]) &&
+		COMMAND_DATA_NOT_VALIDATION (frame->data16 [0]) && frame->data16 [1] >= MC24LC32_SIZE)
+	{
+		const mc24lc32CanVariable_t* variable = mc24lc32CanFindVariable (can, frame->data16 [1]);
+		if (variable != NULL)
+		{
+			transmitDataResponse (can->driver, RESPONSE_TIMEOUT, frame->SID + 1, variable->address, variable->data,
+				variable->size);
+			return;
+		}
+	}
+
+	// Standard commands
+	if (!EXTENDED_IS_EXTENDED (frame->data8 [0]))
+	{
+		handleStandardCommand (frame, can->driver, can->eeprom, can->readonlyCallback, can);
+		return;
+	}
+
+	switch (EXTENDED_OPCODE (frame->data8 [0]))
+	{
+	case OPCODE_BLOCK_READ:
+		handleBlockStart (can, frame, true);
+		break;
+	case OPCODE_BLOCK_WRITE:
+		handleBlockStart (can, frame, false);
+		break;
+	case OPCODE_BLOCK_DATA:
+		handleBlockData (can, frame);
+		break;
+	case OPCODE_BLOCK_ACK:
+		handleBlockAck (can, frame);
+		break;
+	case OPCODE_BLOCK_END:
+		handleBlockEnd (can, frame);
+		break;
+	case OPCODE_TRANSACTION:
+		handleTransaction (can, frame);
+		break;
+	case OPCODE_SUBSCRIBE:
+		handleSubscribe (can, frame);
+		break;
+	}
+}
+
+void mc24lc32CanStream (mc24lc32Can_t* can)
+{
+	chMtxLock (&can->mutex);
+
+	systime_t timeCurrent = chVTGetSystemTime ();
+
+	uint8_t data [STREAM_FRAME_SIZE];
+	uint8_t dataCount = 0;
+	uint8_t slotMask = 0;
+
+	for (uint8_t slot = 0; slot < MC24LC32_CAN_SUBSCRIPTION_COUNT; ++slot)
+	{
+		mc24lc32CanSubscription_t* subscription = &can->subscriptions [slot];
+		if (subscription->variable == NULL)
+			continue;
+
+		// Skip subscriptions that are not due
+		sysinterval_t elapsed = chTimeDiffX (subscription->time, timeCurrent);
+		if (elapsed < subscription->period)
+			continue;
+
+		// Keep the stream periodic, unless it fell behind by more than a period.
+		if (elapsed < 2 * subscription->period)
+			subscription->time += subscription->period;
+		else
+			subscription->time = timeCurrent;
+
+		// If the value does not fit in this message, send it and start the next.
+		const mc24lc32CanVariable_t* variable = subscription->variable;
+		if (dataCount + variable->size > STREAM_FRAME_SIZE)
+		{
+			transmitStream (can, slotMask, data, dataCount);
+			dataCount = 0;
+			slotMask = 0;
+		}
+
+		memcpy (data + dataCount, variable->data, variable->size);
+		dataCount += variable->size;
+		slotMask |= 1 << slot;
+	}
+
+	if (slotMask != 0)
+		transmitStream (can, slotMask, data, dataCount);
+
+	chMtxUnlock (&can->mutex);
+}
+
+const mc24lc32CanVariable_t* mc24lc32CanFindVariable (mc24lc32Can_t* can, uint16_t address)
+{
+	// Binary search of the registry
+	uint16_t lower = 0;
+	uint16_t upper = can->variableCount;
+	while (lower < upper)
+	{
+		uint16_t middle = lower + (upper - lower) / 2;
+		uint16_t middleAddress = can->variables [middle].address;
+
+		if (middleAddress == address)
+			return &can->variables [middle];
+
+		if (middleAddress < address)
+			lower = middle + 1;
+		else
+			upper = middle;
+	}
+
+	return NULL;
+}
+
+void handleSubscribe (mc24lc32Can_t* can, CANRxFrame* frame)
+{
+	uint8_t slot = frame->data8 [1];
+
+	uint16_t address;
+	uint16_t period;
+	memcpy (&address, frame->data8 + 2, sizeof (address));
+	memcpy (&period, frame->data8 + 4, sizeof (period));
+
+	uint16_t responseId = frame->SID + 1;
+
+	const mc24lc32CanVariable_t* variable = mc24lc32CanFindVariable (can, address);
+	if (slot >= MC24LC32_CAN_SUBSCRIPTION_COUNT || (period != 0 && variable == NULL))
+	{
+		transmitSubscribeResponse (can->driver, responseId, slot, MC24LC32_CAN_STATUS_INVALID_RANGE);
+		return;
+	}
+
+	chMtxLock (&can->mutex);
+
+	mc24lc32CanSubscription_t* subscription = &can->subscriptions [slot];
+	subscription->variable	= period != 0 ? variable : NULL;
+	subscription->period	= TIME_MS2I (period);
+	subscription->time		= chVTGetSystemTime () - subscription->period;
+	can->streamId			= responseId;
+
+	chMtxUnlock (&can->mutex);
+
+	transmitSubscribeResponse (can->driver, responseId, slot, MC24LC32_CAN_STATUS_OK);
+}
+
+void handleTransaction (mc24lc32Can_t* can, CANRxFrame* frame)
+{
+	uint8_t action = frame->data8 [1];
+	uint16_t responseId = frame->SID + 1;
+	mc24lc32CanStatus_t status = MC24LC32_CAN_STATUS_OK;
+
+	switch (action)
+	{
+	case TRANSACTION_BEGIN:
+		// Note beginning a transaction while in one continues it.
+		can->transaction = true;
+		can->transactionTime = chVTGetSystemTime ();
+		break;
+
+	case TRANSACTION_COMMIT:
+		if (!can->transaction)
+		{
+			status = MC24LC32_CAN_STATUS_NO_TRANSACTION;
+			break;
+		}
+
+		if (!commitTransaction (can))
+			status = MC24LC32_CAN_STATUS_WRITE_FAILED;
+		break;
+
+	case TRANSACTION_ABORT:
+		if (!can->transaction)
+		{
+			status = MC24LC32_CAN_STATUS_NO_TRANSACTION;
+			break;
+		}
+
+		abortTransaction (can);
+		break;
+
+	default:
+		return;
+	}
+
+	transmitTransactionResponse (can->driver, responseId, action, status);
+}
+
+/// @brief Ends the transaction, copying its staged bytes into the cache and committing them. Staging is per byte, such that
+/// modifications made to the cache during the transaction are not overwritten (unless the transaction modified the same
+/// bytes). Note any other modifications pending in the cache are committed as well.
+bool commitTransaction (mc24lc32Can_t* can)
+{
+	for (uint16_t address = 0; address < MC24LC32_DATA_SIZE; ++address)
+	{
+		if (!BYTE_IS_STAGED (can, address))
+			continue;
+
+		mc24lc32CacheWrite (can->eeprom, address, &can->transactionData [address], 1);
+	}
+
+	// Write every page modified during the transaction, once. If this fails, the pages remain marked in the cache, so are
+	// re-attempted by the next commit.
+	can->transaction = false;
+	memset (can->transactionBytes, 0, sizeof (can->transactionBytes));
+	return mc24lc32Commit (can->eeprom);
+}
+
+/// @brief Ends the transaction, discarding its staged bytes. The cache is not modified.
+void abortTransaction (mc24lc32Can_t* can)
+{
+	can->transaction = false;
+	memset (can->transactionBytes, 0, sizeof (can->transactionBytes));
+}
+
+/// @brief Reads a section of memory as seen by the transaction, that is its staged bytes, falling back to the cache.
+void transactionRead (mc24lc32Can_t* can, uint16_t address, uint8_t* data, uint16_t count)
+{
+	for (uint16_t index = 0; index < count; ++index)
+	{
+		uint16_t byteAddress = address + index;
+		data [index] = BYTE_IS_STAGED (can, byteAddress) ? can->transactionData [byteAddress] :
+			can->eeprom->cache [byteAddress];
+	}
+}
+
+/// @brief Writes a section of memory in the transaction, staging the modified bytes.
+void transactionWrite (mc24lc32Can_t* can, uint16_t address, const uint8_t* data, uint16_t count)
+{
+	memcpy (can->transactionData + address, data, count);
+
+	for (uint16_t byteAddress = address; byteAddress < address + count; ++byteAddress)
+		can->transactionBytes [byteAddress / 8] |= 1u << (byteAddress % 8);
+}
+
+void handleBlockStart (mc24lc32Can_t* can, CANRxFrame* frame, bool readNotWrite)
+{
+	// Abort any transfer in progress
+	abortBlock (can);
+
+	uint16_t address;
+	uint16_t count;
+	memcpy (&address, frame->data8 + 2, sizeof (address));
+	memcpy (&count, frame->data8 + 4, sizeof (count));
+
+	can->blockResponseId = frame->SID + 1;
+
+	// Only the cache is accessible
+	if (count == 0 || address > MC24LC32_DATA_SIZE || count > MC24LC32_DATA_SIZE - address)
+	{
+		transmitBlockEnd (can, MC24LC32_CAN_STATUS_INVALID_RANGE, 0);
+		return;
+	}
+
+	uint8_t window = frame->data8 [1];
+	if (window == 0)
+		window = 1;
+	if (window > MC24LC32_CAN_WINDOW_MAX)
+		window = MC24LC32_CAN_WINDOW_MAX;
+
+	can->blockAddress				= address;
+	can->blockCount					= count;
+	can->blockFrameCount			= (count + BLOCK_FRAME_SIZE - 1) / BLOCK_FRAME_SIZE;
+	can->blockFrameIndex			= 0;
+	can->blockFrameAcked			= 0;
+	can->blockWindow				= window;
+	can->blockRetransmitRequested	= false;
+
+	if (readNotWrite)
+	{
+		// Snapshot the range, such that the transfer is consistent even if the memory is modified during it. Then start
+		// streaming the first window.
+		transactionRead (can, address, can->blockData, count);
+		can->blockState = MC24LC32_CAN_BLOCK_READ;
+		transmitBlockWindow (can, false);
+	}
+	else
+	{
+		// Indicate the node is ready to receive
+		can->blockState = MC24LC32_CAN_BLOCK_WRITE;
+		transmitBlockAck (can, 0, false);
+	}
+}
+
+void handleBlockData (mc24lc32Can_t* can, CANRxFrame* frame)
+{
+	if (can->blockState != MC24LC32_CAN_BLOCK_WRITE || can->blockFrameIndex == can->blockFrameCount)
+		return;
+
+	// On a gap in the sequence, request a retransmission from the first missing frame. Frames following the gap are
+	// discarded, as they will be retransmitted.
+	if (frame->data8 [1] != (uint8_t) can->blockFrameIndex)
+	{
+		if (!can->blockRetransmitRequested)
+		{
+			transmitBlockAck (can, can->blockFrameIndex, true);
+			can->blockFrameAcked = can->blockFrameIndex;
+			can->blockRetransmitRequested = true;
 		}
+		return;
+	}
+
+	// Store the data, the last frame may be partial. The data is only applied once the transfer's CRC is verified.
+	uint16_t offset = can->blockFrameIndex * BLOCK_FRAME_SIZE;
+	uint16_t count = can->blockCount - offset;
+	if (count > BLOCK_FRAME_SIZE)
+		count = BLOCK_FRAME_SIZE;
+
+	memcpy (can->blockData + offset, frame->data8 + 2, count);
+	++can->blockFrameIndex;
+	can->blockRetransmitRequested = false;
+
+	// Acknowledge every half-window, and the last frame.
+	uint8_t ackInterval = can->blockWindow / 2 > 0 ? can->blockWindow / 2 : 1;
+	if (can->blockFrameIndex == can->blockFrameCount || can->blockFrameIndex - can->blockFrameAcked >= ackInterval)
+	{
+		transmitBlockAck (can, can->blockFrameIndex, false);
+		can->blockFrameAcked = can->blockFrameIndex;
+	}
+}
+
+void handleBlockAck (mc24lc32Can_t* can, CANRxFrame* frame)
+{
+	if (can->blockState != MC24LC32_CAN_BLOCK_READ)
+		return;
+
+	// Reconstruct the frame index from the sequence number. Valid acknowledgements are between the last acknowledgement and
+	// the last frame sent.
+	uint16_t acked = can->blockFrameAcked + (uint8_t) (frame->data8 [1] - (uint8_t) can->blockFrameAcked);
+	if (acked > can->blockFrameIndex)
+		return;
+
+	can->blockFrameAcked = acked;
+	bool retransmit = EXTENDED_RETRANSMIT (frame->data8 [0]);
+
+	// Acknowledgement of the final frame ends the transfer.
+	if (acked == can->blockFrameCount && !retransmit)
+	{
+		can->blockState = MC24LC32_CAN_BLOCK_IDLE;
+		return;
+	}
+
+	// Go back to the first missing frame, if requested.
+	if (retransmit)
+		can->blockFrameIndex = acked;
+
+	transmitBlockWindow (can, retransmit);
+}
+
+void handleBlockEnd (mc24lc32Can_t* can, CANRxFrame* frame)
+{
+	// If the write was already completed, the response was lost, re-send it.
+	if (can->blockState == MC24LC32_CAN_BLOCK_COMPLETE)
+	{
+		transmitBlockEnd (can, can->blockStatus, crc32Calculate (can->blockData, can->blockCount));
+		return;
+	}
+
+	if (can->blockState != MC24LC32_CAN_BLOCK_WRITE)
+		return;
+
+	// If frames are missing, request their retransmission. Note this is always responded to, as it is how the host recovers
+	// from a lost acknowledgement.
+	if (can->blockFrameIndex != can->blockFrameCount)
+	{
+		transmitBlockAck (can, can->blockFrameIndex, true);
+		can->blockFrameAcked = can->blockFrameIndex;
+		can->blockRetransmitRequested = true;
+		return;
+	}
+
+	uint32_t crc;
+	memcpy (&crc, frame->data8 + 2, sizeof (crc));
+
+	uint32_t crcReceived = crc32Calculate (can->blockData, can->blockCount);
+
+	if (crc != crcReceived)
+	{
+		// Discard the corrupt data. As it was never applied, nothing else is affected.
+		can->blockStatus = MC24LC32_CAN_STATUS_CRC_MISMATCH;
+	}
+	else if (can->transaction)
+	{
+		// Stage the range, it is committed by the transaction's commit.
+		transactionWrite (can, can->blockAddress, can->blockData, can->blockCount);
+		can->blockStatus = MC24LC32_CAN_STATUS_OK;
+	}
+	else
+	{
+		// Commit the range, writing each page once.
+		if (mc24lc32WriteThrough (can->eeprom, can->blockAddress, can->blockData, can->blockCount))
+			can->blockStatus = MC24LC32_CAN_STATUS_OK;
+		else
+			can->blockStatus = MC24LC32_CAN_STATUS_WRITE_FAILED;
+	}
+
+	can->blockState = MC24LC32_CAN_BLOCK_COMPLETE;
+	transmitBlockEnd (can, can->blockStatus, crcReceived);
+}
+
+void abortBlock (mc24lc32Can_t* can)
+{
+	// Any data an incomplete write received was never applied, so is simply discarded.
+	can->blockState = MC24LC32_CAN_BLOCK_IDLE;
+}
+
+/// @brief Transmits the frames of a block read that fit in the window. The block end is transmitted after the last frame,
+/// or re-transmitted if a retransmission is requested after the last frame.
+void transmitBlockWindow (mc24lc32Can_t* can, bool retransmit)
+{
+	bool lastSent = retransmit && can->blockFrameIndex == can->blockFrameCount;
+
+	while (can->blockFrameIndex < can->blockFrameCount && can->blockFrameIndex - can->blockFrameAcked < can->blockWindow)
+	{
+		// If the frame cannot be sent, stop, the host will request its retransmission.
+		if (transmitBlockData (can, can->blockFrameIndex) != MSG_OK)
+			return;
+
+		++can->blockFrameIndex;
+		lastSent = can->blockFrameIndex == can->blockFrameCount;
 	}
+
+	if (lastSent)
+		transmitBlockEnd (can, MC24LC32_CAN_STATUS_OK, crc32Calculate (can->blockData, can->blockCount));
+}
+
+msg_t transmitBlockData (mc24lc32Can_t* can, uint16_t frameIndex)
+{
+	uint16_t offset = frameIndex * BLOCK_FRAME_SIZE;
+	uint16_t count = can->blockCount - offset;
+	if (count > BLOCK_FRAME_SIZE)
+		count = BLOCK_FRAME_SIZE;
+
+	CANTxFrame frame =
+	{
+		.DLC	= 2 + count,
+		.IDE	= CAN_IDE_STD,
+		.SID	= can->blockResponseId,
+		.data8	=
+		{
+			EXTENDED_INSTRUCTION (OPCODE_BLOCK_DATA, false),
+			(uint8_t) frameIndex
+		}
+	};
+
+	memcpy (frame.data8 + 2, can->blockData + offset, count);
+
+	return canTransmitTimeout (can->driver, CAN_ANY_MAILBOX, &frame, BLOCK_TIMEOUT);
+}
+
+msg_t transmitBlockAck (mc24lc32Can_t* can, uint16_t frameIndex, bool retransmit)
+{
+	CANTxFrame frame =
+	{
+		.DLC	= 2,
+		.IDE	= CAN_IDE_STD,
+		.SID	= can->blockResponseId,
+		.data8	=
+		{
+			EXTENDED_INSTRUCTION (OPCODE_BLOCK_ACK, retransmit),
+			(uint8_t) frameIndex
+		}
+	};
+
+	return canTransmitTimeout (can->driver, CAN_ANY_MAILBOX, &frame, RESPONSE_TIMEOUT);
+}
+
+msg_t transmitBlockEnd (mc24lc32Can_t* can, mc24lc32CanStatus_t status, uint32_t crc)
+{
+	CANTxFrame frame =
+	{
+		.DLC	= 6,
+		.IDE	= CAN_IDE_STD,
+		.SID	= can->blockResponseId,
+		.data8	=
+		{
+			EXTENDED_INSTRUCTION (OPCODE_BLOCK_END, false),
+			(uint8_t) status
+		}
+	};
+
+	memcpy (frame.data8 + 2, &crc, sizeof (crc));
+
+	return canTransmitTimeout (can->driver, CAN_ANY_MAILBOX, &frame, RESPONSE_TIMEOUT);
+}
+
+msg_t transmitTransactionResponse (CANDriver* driver, uint16_t id, uint8_t action, mc24lc32CanStatus_t status)
+{
+	CANTxFrame frame =
+	{
+		.DLC	= 3,
+		.IDE	= CAN_IDE_STD,
+		.SID	= id,
+		.data8	=
+		{
+			EXTENDED_INSTRUCTION (OPCODE_TRANSACTION, false),
+			action,
+			(uint8_t) status
+		}
+	};
+
+	return canTransmitTimeout (driver, CAN_ANY_MAILBOX, &frame, RESPONSE_TIMEOUT);
+}
+
+msg_t transmitSubscribeResponse (CANDriver* driver, uint16_t id, uint8_t slot, mc24lc32CanStatus_t status)
+{
+	CANTxFrame frame =
+	{
+		.DLC	= 3,
+		.IDE	= CAN_IDE_STD,
+		.SID	= id,
+		.data8	=
+		{
+			EXTENDED_INSTRUCTION (OPCODE_SUBSCRIBE, false),
+			slot,
+			(uint8_t) status
+		}
+	};
+
+	return canTransmitTimeout (driver, CAN_ANY_MAILBOX, &frame, RESPONSE_TIMEOUT);
+}
+
+msg_t transmitStream (mc24lc32Can_t* can, uint8_t slotMask, const uint8_t* data, uint8_t dataCount)
+{
+	CANTxFrame frame =
+	{
+		.DLC	= 2 + dataCount,
+		.IDE	= CAN_IDE_STD,
+		.SID	= can->streamId,
+		.data8	=
+		{
+			EXTENDED_INSTRUCTION (OPCODE_STREAM, false),
+			slotMask
+		}
+	};
+
+	memcpy (frame.data8 + 2, data, dataCount);
+
+	return canTransmitTimeout (can->driver, CAN_ANY_MAILBOX, &frame, STREAM_TIMEOUT);
 }
 
 msg_t transmitDataResponse (CANDriver* driver, sysinterval_t timeout, uint16_t id, uint16_t address, const void* data, uint8_t dataCount)
@@ -8,6 +8,24 @@
 //
 // Description: Group of functions for sending / receiving EEPROM-related CAN messages.
 //
+//   The standard commands transfer at most 4 bytes per request / response pair. For larger transfers, the extended block
+//   commands stream an address range as a sequence of frames carrying 6 bytes each. The sender transmits up to a window's
+//   worth of frames ahead of the receiver's last acknowledgement, the receiver acknowledging every half-window. A gap in the
+//   sequence is recovered by requesting a retransmission from the first missing frame (go-back-N). The transfer ends with the
+//   CRC-32 of the range (see crc32.h), writes are only committed if the CRC matches. Block transfers require the stateful
+//   interface (see mc24lc32CanInit).
+//
+//   Writes may also be grouped into a transaction, the commit writing each modified page once (rather than once per write).
+//   The transaction's writes are staged in the handler, rather than in the EEPROM's cache. Only the commit copies the staged
+//   bytes into the cache, meaning commits made elsewhere (ex. by the application) never write a transaction's uncommitted
+//   modifications, and aborting a transaction discards only its own modifications. Likewise, the data of a block
+//   write is received into a separate buffer, only being applied once its CRC is verified.
+//
+//   Readonly variables (addresses past the end of the EEPROM's memory) are looked up in a registry, a table sorted by
+//   address, falling back to the readonly callback for any address not in it. Rather than polling, the host may subscribe
+//   to registered variables, which are then streamed at the requested rate, multiple values being packed into each
+//   message (see mc24lc32CanStream).
+//
 // TODO(Barach): Shorten this handshake.
 
 // Includes -------------------------------------------------------------------------------------------------------------------
@@ -15,8 +33,40 @@
 // Includes
 #include "peripherals/mc24lc32.h"
 
+// ChibiOS
+#include "ch.h"
+
+// Constants ------------------------------------------------------------------------------------------------------------------
+
+/// @brief The maximum size of a readonly variable, in bytes (the data of a standard response).
+#define MC24LC32_CAN_VARIABLE_SIZE_MAX 4
+
+/// @brief The maximum window size of a block transfer, in frames. Larger requested windows are clamped to this.
+#define MC24LC32_CAN_WINDOW_MAX 32
+
+/// @brief The maximum number of simultaneous subscriptions.
+#define MC24LC32_CAN_SUBSCRIPTION_COUNT 8
+
 // Datatypes ------------------------------------------------------------------------------------------------------------------
 
+/// @brief Status of a completed block transfer, as reported by the block end response.
+typedef enum
+{
+	MC24LC32_CAN_STATUS_OK				= 0,
+	MC24LC32_CAN_STATUS_INVALID_RANGE	= 1,
+	MC24LC32_CAN_STATUS_CRC_MISMATCH	= 2,
+	MC24LC32_CAN_STATUS_WRITE_FAILED	= 3,
+	MC24LC32_CAN_STATUS_NO_TRANSACTION	= 4
+} mc24lc32CanStatus_t;
+
+typedef enum
+{
+	MC24LC32_CAN_BLOCK_IDLE		= 0,
+	MC24LC32_CAN_BLOCK_READ		= 1,
+	MC24LC32_CAN_BLOCK_WRITE	= 2,
+	MC24LC32_CAN_BLOCK_COMPLETE	= 3
+} mc24lc32CanBlockState_t;
+
 /**
  * @brief Addresses above 4096 may be mapped to readonly variables. This callback function is used to request the value of a
  * variable based on the given address.
@@ -27,11 +77,134 @@
  */
 typedef bool mc24lc32ReadonlyCallback_t (uint16_t addr, void** data, uint8_t* dataCount);
 
+/// @brief Entry of the readonly variable registry.
+typedef struct
+{
+	/// @brief The address of the variable, must be at least @c MC24LC32_SIZE .
+	uint16_t address;
+
+	/// @brief The size of the variable in bytes, from 1 to @c MC24LC32_CAN_VARIABLE_SIZE_MAX .
+	uint8_t size;
+
+	/// @brief The variable itself.
+	const void* data;
+} mc24lc32CanVariable_t;
+
+/// @brief A subscription to a readonly variable.
+typedef struct
+{
+	/// @brief The subscribed variable, @c NULL if the subscription is inactive.
+	const mc24lc32CanVariable_t* variable;
+
+	/// @brief The period to stream the variable at.
+	sysinterval_t period;
+
+	/// @brief The time the variable was last streamed at.
+	systime_t time;
+} mc24lc32CanSubscription_t;
+
+typedef struct
+{
+	/// @brief The CAN driver to transmit responses on.
+	CANDriver* driver;
+
+	/// @brief The EEPROM to read from / write to.
+	mc24lc32_t* eeprom;
+
+	/// @brief Hook for accessing readonly variable data not in the registry. Use @c NULL to disable.
+	mc24lc32ReadonlyCallback_t* readonlyCallback;
+
+	/// @brief The readonly variable registry, must be sorted by address (ascending). Use @c NULL for an empty registry.
+	const mc24lc32CanVariable_t* variables;
+
+	/// @brief The number of elements in @c variables .
+	uint16_t variableCount;
+} mc24lc32CanConfig_t;
+
+/**
+ * @brief Stateful handler of EEPROM command messages, supporting both the standard and the extended (block) commands.
+ */
+typedef struct
+{
+	/// @brief The CAN driver to transmit responses on.
+	CANDriver* driver;
+
+	/// @brief The EEPROM to read from / write to.
+	mc24lc32_t* eeprom;
+
+	/// @brief Hook for accessing readonly variable data.
+	mc24lc32ReadonlyCallback_t* readonlyCallback;
+
+	/// @brief The readonly variable registry.
+	const mc24lc32CanVariable_t* variables;
+
+	/// @brief The number of elements in @c variables .
+	uint16_t variableCount;
+
+	/// @brief The active subscriptions, indexed by slot.
+	mc24lc32CanSubscription_t subscriptions [MC24LC32_CAN_SUBSCRIPTION_COUNT];
+
+	/// @brief The ID to transmit stream messages with.
+	uint16_t streamId;
+
+	/// @brief Mutex protecting the subscriptions, as streaming is typically performed by a different thread than command
+	/// handling.
+	mutex_t mutex;
+
+	/// @brief The state of the current block transfer.
+	mc24lc32CanBlockState_t blockState;
+
+	/// @brief The ID to transmit the block transfer's frames with.
+	uint16_t blockResponseId;
+
+	/// @brief The address of the block transfer's range.
+	uint16_t blockAddress;
+
+	/// @brief The size of the block transfer's range, in bytes.
+	uint16_t blockCount;
+
+	/// @brief The number of data frames of the block transfer.
+	uint16_t blockFrameCount;
+
+	/// @brief For reads, the index of the next frame to transmit. For writes, the index of the next frame expected.
+	uint16_t blockFrameIndex;
+
+	/// @brief The number of frames acknowledged by the receiver.
+	uint16_t blockFrameAcked;
+
+	/// @brief The window size of the block transfer, in frames.
+	uint8_t blockWindow;
+
+	/// @brief The status of the last completed block write, re-sent if its block end is repeated (its response was lost).
+	mc24lc32CanStatus_t blockStatus;
+
+	/// @brief The data of the block transfer's range. For reads, a snapshot of the range taken at the start of the transfer.
+	/// For writes, the received data, which is only applied once its CRC is verified.
+	uint8_t blockData [MC24LC32_DATA_SIZE];
+
+	/// @brief Indicates a transaction is in progress, meaning writes are not committed until the transaction is.
+	bool transaction;
+
+	/// @brief The time of the last command received during the transaction.
+	systime_t transactionTime;
+
+	/// @brief The modifications of the transaction in progress. Only the bytes marked in @c transactionBytes are staged, the
+	/// remaining bytes are those of the cache.
+	uint8_t transactionData [MC24LC32_DATA_SIZE];
+
+	/// @brief Bitmask of the bytes modified by the transaction in progress.
+	uint8_t transactionBytes [MC24LC32_DATA_SIZE / 8];
+
+	/// @brief Indicates a retransmission was requested for the current gap in the sequence, such that it is only requested
+	/// once.
+	bool blockRetransmitRequested;
+} mc24lc32Can_t;
+
 // Functions ------------------------------------------------------------------------------------------------------------------
 
 /**
  * @brief Handles an EEPROM command message. Depending on the instruction of the command, the appropriate read / write is
- * executed and, if applicable, a response message is sent.
+ * executed and, if applicable, a response message is sent. Extended commands are ignored, see @c mc24lc32CanHandleCommand .
  * @param frame The received CAN frame of the command message.
  * @param driver The CAN driver to transmit the response on.
  * @param eeprom The EEPROM to read from / write to.
@@ -40,4 +213,38 @@ typedef bool mc24lc32ReadonlyCallback_t (uint16_t addr, void** data, uint8_t* da
 void mc24lc32HandleCanCommand (CANRxFrame* frame, CANDriver* driver, mc24lc32_t* eeprom,
 	mc24lc32ReadonlyCallback_t readonlyCallback);
 
+/**
+ * @brief Initializes a stateful EEPROM command handler using the specified configuration.
+ * @note If the readonly variable registry is invalid (an entry has an invalid size or address, or the entries are not
+ * sorted), it is disabled, the handler still being usable.
+ * @param can The handler to initialize.
+ * @param config The configuration to use.
+ * @return True if successful, false if the registry is invalid.
+ */
+bool mc24lc32CanInit (mc24lc32Can_t* can, const mc24lc32CanConfig_t* config);
+
+/**
+ * @brief Handles an EEPROM command message, including the extended (block) commands. Standard commands are handled as by
+ * @c mc24lc32HandleCanCommand .
+ * @note A block transfer started while another is in progress aborts the latter, discarding any data it received.
+ * @param can The handler to use.
+ * @param frame The received CAN frame of the command message.
+ */
+void mc24lc32CanHandleCommand (mc24lc32Can_t* can, CANRxFrame* frame);
+
+/**
+ * @brief Transmits the values of all subscriptions that are due. Values are packed into as few messages as possible. This
+ * should be called periodically, at least as often as the shortest subscription period.
+ * @param can The handler to use.
+ */
+void mc24lc32CanStream (mc24lc32Can_t* can);
+
+/**
+ * @brief Looks up a variable in the readonly variable registry.
+ * @param can The handler whose registry to search.
+ * @param address The address of the variable.
+ * @return The variable, or @c NULL if the address is not registered.
+ */
+const mc24lc32CanVariable_t* mc24lc32CanFindVariable (mc24lc32Can_t* can, uint16_t address);
+
 #endif // MC24LC32_CAN_H
\ No newline at end of file
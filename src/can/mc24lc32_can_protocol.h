@@ -0,0 +1,41 @@
+#ifndef MC24LC32_CAN_PROTOCOL_H
+#define MC24LC32_CAN_PROTOCOL_H
+
+// MC24LC32 CAN Protocol ------------------------------------------------------------------------------------------------------
+//
+// Author: agent
+// Date Created: 2026.10.17
+//
+// Description: Wire format of the extended EEPROM commands, shared by the node's command handler (mc24lc32_can.c) and the
+//   host-side tooling (host/mc24lc32_cli.c), such that both ends of the protocol are built from the same definitions. See
+//   mc24lc32CanHandleCommand for the layout of each message.
+
+// Extended Command / Response Message ----------------------------------------------------------------------------------------
+
+#define EXTENDED_IS_EXTENDED(byte)			(((byte) & 0b00010011) == 0b00010011)
+#define EXTENDED_RETRANSMIT(byte)			(((byte) & 0b00000100) == 0b00000100)
+#define EXTENDED_OPCODE(byte)				(((byte) & 0b11100000) >> 5)
+#define EXTENDED_INSTRUCTION(opcode, rt)	((uint8_t) (0b00010011 | (((uint8_t) (rt)) << 2) | ((opcode) << 5)))
+
+// Extended Opcodes
+#define OPCODE_BLOCK_READ					0
+#define OPCODE_BLOCK_WRITE					1
+#define OPCODE_BLOCK_DATA					2
+#define OPCODE_BLOCK_ACK					3
+#define OPCODE_BLOCK_END					4
+#define OPCODE_TRANSACTION					5
+#define OPCODE_SUBSCRIBE					6
+#define OPCODE_STREAM						7
+
+// Transaction Actions
+#define TRANSACTION_BEGIN					0
+#define TRANSACTION_COMMIT					1
+#define TRANSACTION_ABORT					2
+
+/// @brief Number of bytes of data carried by each block data frame.
+#define BLOCK_FRAME_SIZE					6
+
+/// @brief Number of bytes of data carried by each stream message.
+#define STREAM_FRAME_SIZE					6
+
+#endif // MC24LC32_CAN_PROTOCOL_H
\ No newline at end of file
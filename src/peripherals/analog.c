@@ -1,81 +1,1181 @@
 // Header
 #include "analog.h"
 
+// Includes
+#include "controls/transfer_function.h"
+
+// C Standard Library
+#include <stddef.h>
+#include <string.h>
+
+// Constants ------------------------------------------------------------------------------------------------------------------
+
+/// @brief The period over which the sample rate of continuous mode is measured.
+#define SAMPLE_RATE_PERIOD TIME_S2I (1)
+
+/// @brief The number of analog inputs of the ADC (16 external, the temperature sensor, VREFINT and VBAT).
+#define INPUT_COUNT 19
+
+/// @brief The number of ADC clock cycles taken to convert a sample (12-bit resolution), excluding the sample time.
+#define CONVERSION_CYCLES 12
+
+/// @brief The frequency of the ADC's clock, the APB2 clock divided by the common prescaler.
+#define ADC_CLOCK_FREQUENCY (STM32_PCLK2 / (2 * (STM32_ADC_ADCPRE + 1)))
+
+/// @brief The number of sweeps in each block of the circular buffer.
+#define BLOCK_SWEEP_COUNT (ANALOG_BUFFER_DEPTH / 2)
+
+/// @brief The maximum sample value, used for bounding sums.
+#define SAMPLE_MAX 4095
+
+// The block sum of a channel must fit in a halfword lane.
+#if BLOCK_SWEEP_COUNT * SAMPLE_MAX > UINT16_MAX
+#error "ANALOG_BUFFER_DEPTH is too large for the block sum's halfword lanes."
+#endif
+
+/// @brief The MULTI value of the common control register for each number of ADCs in regular simultaneous mode.
+#define MULTI_DUAL_REGULAR_SIMULTANEOUS 0b00110
+#define MULTI_TRIPLE_REGULAR_SIMULTANEOUS 0b10110
+
+/// @brief The counter frequency of the timer of triggered mode. The sample period is a whole number of counts.
+#define TRIGGER_COUNTER_FREQUENCY 1000000
+
+// Global Constants -----------------------------------------------------------------------------------------------------------
+
+/// @brief The number of ADC clock cycles of each sample time, indexed by the SMPR value.
+static const uint16_t SAMPLE_TIME_CYCLES [] =
+{
+	3, 15, 28, 56, 84, 112, 144, 480
+};
+
+// Function Prototypes --------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Computes the sample time registers of a configuration. If an input appears multiple times in the sequence (or in
+ * both groups), the longest of its sample times is used.
+ * @param injectedCycles Written to contain the number of ADC clock cycles taken by the injected sequence.
+ * @return The number of ADC clock cycles taken by each sweep of the sequence. In simultaneous mode, each rank takes the
+ * longest of its conversions.
+ */
+uint32_t analogConfigureSampleTimes (analogConfig_t* config, uint8_t adcCount, uint32_t* smpr1, uint32_t* smpr2,
+	uint32_t* injectedCycles);
+
+/**
+ * @brief Computes the injected sequence register and the injected group's bits of the control registers of a
+ * configuration.
+ * @return True if the injected group's configuration is valid (or it is disabled), false otherwise.
+ */
+bool analogConfigureInjected (analogConfig_t* config, uint32_t* jsqr, uint32_t* cr1, uint32_t* cr2);
+
+/**
+ * @brief Handles the injected group's completion, calling the handler of each injected channel.
+ */
+void analogInjectedInterrupt (ADCDriver* driver, uint32_t sr);
+
+/**
+ * @brief Computes the analog watchdog bits of the control register 1 of a configuration, clamping its window to the
+ * 12-bit range.
+ * @param cr1 Written to contain the watchdog bits.
+ * @return True if the watchdog's configuration is valid (or it is disabled), false otherwise.
+ */
+bool analogConfigureWatchdog (analogConfig_t* config, uint8_t adcCount, uint32_t* cr1);
+
+/**
+ * @brief Checks whether every sample of the channels guarded by the analog watchdog in a block is within the window.
+ */
+bool analogIsBlockInWindow (analog_t* analog, const adcsample_t* block);
+
+/**
+ * @brief Computes the sequence registers (SQR1 to SQR3, excluding the length) of one of the ADCs of a configuration. Entry
+ * @c i of the configuration's sequence is converted by ADC @c i % @c adcCount at rank @c i / @c adcCount .
+ */
+void analogConfigureSequence (analogConfig_t* config, uint8_t adc, uint8_t adcCount, uint32_t* sqr);
+
+#if STM32_ADC_USE_ADC1
+
+/**
+ * @brief Configures ADC2 (and ADC3) as slaves of ADC1 in regular simultaneous mode. Must be called after ADC1 is started,
+ * as starting it resets the common configuration.
+ */
+void analogStartSimultaneous (analog_t* analog, uint8_t adcCount, uint32_t smpr1, uint32_t smpr2);
+
+#endif // STM32_ADC_USE_ADC1
+
+#if HAL_USE_GPT
+
+/**
+ * @brief Starts a timer generating a TRGO event at the specified frequency.
+ * @param conversionTime The duration of the triggered conversion, in nanoseconds, the period must be longer than this.
+ * @param timerConfig Written to contain the configuration of the timer, must persist while the timer is running.
+ * @param period Written to contain the period of the timer, in microseconds.
+ * @return True if successful, false if the frequency is invalid.
+ */
+bool analogStartTimer (GPTDriver* timer, uint32_t frequency, uint32_t conversionTime, GPTConfig* timerConfig,
+	uint32_t* period);
+
+/**
+ * @brief Gets the regular group's external trigger selection (EXTSEL) of a timer's TRGO event.
+ * @return True if successful, false if the timer's TRGO cannot trigger the ADC.
+ */
+bool analogGetTriggerSource (GPTDriver* timer, uint32_t* extsel);
+
+/**
+ * @brief Gets the injected group's external trigger selection (JEXTSEL) of a timer's TRGO event.
+ * @return True if successful, false if the timer's TRGO cannot trigger the injected group.
+ */
+bool analogGetInjectedTriggerSource (GPTDriver* timer, uint32_t* jextsel);
+
+#endif // HAL_USE_GPT
+
+/**
+ * @brief Records the latency of a completed conversion in the statistics.
+ */
+void analogRecordConversion (analog_t* analog, uint32_t latency);
+
+/**
+ * @brief Restarts the driver of a failed conversion, re-applying the configuration the driver does not. Only applicable to
+ * single mode, must be called with the bus acquired.
+ */
+void analogRestart (analog_t* analog);
+
+/**
+ * @brief Gets the object an ADC's current conversion belongs to. Only applicable to conversions started by this module.
+ */
+analog_t* analogFromDriver (ADCDriver* driver);
+
+/**
+ * @brief Stores a sweep of samples as the latest and calls the handler of each channel, followed by the block handler.
+ */
+void analogDispatch (analog_t* analog, const adcsample_t* sweep);
+
+/**
+ * @brief Checks whether a channel's filter configuration is valid.
+ */
+bool analogIsFilterValid (const analogFilterConfig_t* filter);
+
+/**
+ * @brief Feeds a sample of a channel through its filter.
+ * @return The filtered sample, rounded and saturated to the range of a sample.
+ */
+adcsample_t analogFilter (analog_t* analog, uint16_t index, adcsample_t sample);
+
+/**
+ * @brief Feeds all but the last sweep of a block through the filters of the channels that are not oversampled. The last
+ * sweep is filtered when dispatched.
+ */
+void analogFilterBlock (analog_t* analog, const adcsample_t* block);
+
+/**
+ * @brief Sums the sweeps of a block, per channel.
+ * @param block The first sweep of the block.
+ * @param channelCount The number of channels in each sweep.
+ * @param sums Written to contain the sum of each channel.
+ */
+void analogSumBlock (const adcsample_t* block, uint16_t channelCount, uint32_t* sums);
+
+/**
+ * @brief Dispatches a block with oversampled channels. Oversampled channels are accumulated, being dispatched once the
+ * oversampling factor is reached. Other channels are dispatched as normal.
+ */
+void analogDispatchOversampled (analog_t* analog, const adcsample_t* block);
+
+/**
+ * @brief Callback for the completion of a block in continuous mode. Called by the half transfer (first block) and full
+ * transfer (second block) interrupts.
+ */
+void analogBlockCallback (ADCDriver* driver);
+
+/**
+ * @brief Callback for an error of a conversion. The driver stops the conversion on any error, so in continuous / triggered
+ * mode it is restarted.
+ */
+void analogErrorCallback (ADCDriver* driver, adcerror_t error);
+
+// Functions ------------------------------------------------------------------------------------------------------------------
+
 bool analogInit (analog_t* analog, analogConfig_t* config)
 {
 	// Store the configuration.
 	analog->config = config;
 
-	// Compute the conversion group for the ADC.
+	// All modes but single mode convert into the circular buffer.
+	bool circular = config->mode != ANALOG_MODE_SINGLE;
+
+	uint32_t cr2;
+	switch (config->mode)
+	{
+	case ANALOG_MODE_SINGLE:
+		// ADC is started by software.
+		cr2 = ADC_CR2_SWSTART;
+		break;
+
+	case ANALOG_MODE_CONTINUOUS:
+		// ADC is started by software, then re-starts each sweep.
+		cr2 = ADC_CR2_SWSTART | ADC_CR2_CONT;
+		break;
+
+	#if HAL_USE_GPT
+	case ANALOG_MODE_TRIGGERED:
+	{
+		// ADC is started by the rising edge of the timer's TRGO, once per sweep.
+		uint32_t extsel;
+		if (!analogGetTriggerSource (config->timer, &extsel))
+			return false;
+
+		cr2 = ADC_CR2_EXTEN_0 | (extsel << ADC_CR2_EXTSEL_Pos);
+		break;
+	}
+	#endif // HAL_USE_GPT
+
+	default:
+		return false;
+	}
+
+	// Simultaneous mode is only supported with ADC1 as the master, and each ADC must convert the same number of channels.
+	uint8_t adcCount = config->adcCount > 1 ? config->adcCount : 1;
+	if (adcCount > 3 || config->channelCount % adcCount != 0)
+		return false;
+
+	#if STM32_ADC_USE_ADC1
+	if (adcCount > 1 && config->driver != &ADCD1)
+		return false;
+	#else
+	if (adcCount > 1)
+		return false;
+	#endif // STM32_ADC_USE_ADC1
+
+	analog->depthFactor = adcCount;
+
+	uint32_t smpr1;
+	uint32_t smpr2;
+	uint32_t injectedCycles;
+	analog->sweepCycles = analogConfigureSampleTimes (config, adcCount, &smpr1, &smpr2, &injectedCycles);
+	analog->sweepTime = (uint64_t) analog->sweepCycles * 1000000000 / ADC_CLOCK_FREQUENCY;
+
+	uint32_t sqr [3];
+	analogConfigureSequence (config, 0, adcCount, sqr);
+
+	// The watchdog is only applicable to continuous / triggered mode, as the driver stops the conversion when it trips.
+	uint32_t cr1;
+	if (!analogConfigureWatchdog (config, adcCount, &cr1) || (config->watchdogHandler != NULL && !circular))
+		return false;
+
+	// The injected group is only applicable to continuous / triggered mode, as the ADC is otherwise off between samples.
+	uint32_t jsqr;
+	uint32_t injectedCr1;
+	uint32_t injectedCr2;
+	if (!analogConfigureInjected (config, &jsqr, &injectedCr1, &injectedCr2) ||
+		(config->injectedChannelCount != 0 && (!circular || adcCount > 1)))
+		return false;
+
+	cr1 |= injectedCr1;
+	cr2 |= injectedCr2;
+
+	// Compute the conversion group for the ADC. In simultaneous mode, this is the master's sequence. Note the depth of the
+	// conversion is multiplied to account for the slaves' samples.
 	ADCConversionGroup group =
 	{
-		.circular		=	false,
-		.num_channels	=	config->channelCount,
-		.end_cb			= 	NULL,
-		.error_cb		= 	NULL,
-		.cr1			=	0,
-		.cr2			=	ADC_CR2_SWSTART,									// ADC is started by software.
-		.smpr1			=	(ADC_SAMPLE_480 << ADC_SMPR1_SMP15_Pos) |			// Channel 15 sample time.
-							(ADC_SAMPLE_480 << ADC_SMPR1_SMP14_Pos) |			// Channel 14 sample time.
-							(ADC_SAMPLE_480 << ADC_SMPR1_SMP13_Pos) |			// Channel 13 sample time.
-							(ADC_SAMPLE_480 << ADC_SMPR1_SMP12_Pos) |			// Channel 12 sample time.
-							(ADC_SAMPLE_480 << ADC_SMPR1_SMP11_Pos) |			// Channel 11 sample time.
-							(ADC_SAMPLE_480 << ADC_SMPR1_SMP10_Pos),			// Channel 10 sample time.
-		.smpr2			= 	(ADC_SAMPLE_480 << ADC_SMPR2_SMP9_Pos) |			// Channel 9 sample time.
-							(ADC_SAMPLE_480 << ADC_SMPR2_SMP8_Pos) |			// Channel 8 sample time.
-							(ADC_SAMPLE_480 << ADC_SMPR2_SMP7_Pos) |			// Channel 7 sample time.
-							(ADC_SAMPLE_480 << ADC_SMPR2_SMP6_Pos) |			// Channel 6 sample time.
-							(ADC_SAMPLE_480 << ADC_SMPR2_SMP5_Pos) |			// Channel 5 sample time.
-							(ADC_SAMPLE_480 << ADC_SMPR2_SMP4_Pos) |			// Channel 4 sample time.
-							(ADC_SAMPLE_480 << ADC_SMPR2_SMP3_Pos) |			// Channel 3 sample time.
-							(ADC_SAMPLE_480 << ADC_SMPR2_SMP2_Pos) |			// Channel 2 sample time.
-							(ADC_SAMPLE_480 << ADC_SMPR2_SMP1_Pos) |			// Channel 1 sample time.
-							(ADC_SAMPLE_480 << ADC_SMPR2_SMP0_Pos),				// Channel 0 sample time.
-		.htr			=	0,													// No watchdog threshold.
-		.ltr			=	0,
-		.sqr1			= 	(ADC_SQR1_SQ16_N (config->channels [15])) |			// Sample 16 channel index.
-							(ADC_SQR1_SQ15_N (config->channels [14])) |			// Sample 15 channel index.
-							(ADC_SQR1_SQ14_N (config->channels [13])) |			// Sample 14 channel index.
-							(ADC_SQR1_SQ13_N (config->channels [12])),			// Sample 13 channel index.
-		.sqr2			=	(ADC_SQR2_SQ12_N (config->channels [11])) |			// Sample 12 channel index.
-							(ADC_SQR2_SQ11_N (config->channels [10])) |			// Sample 11 channel index.
-							(ADC_SQR2_SQ10_N (config->channels [9])) |			// Sample 10 channel index.
-							(ADC_SQR2_SQ9_N (config->channels [8])) |			// Sample 9 channel index.
-							(ADC_SQR2_SQ8_N (config->channels [7])) |			// Sample 8 channel index.
-							(ADC_SQR2_SQ7_N (config->channels [6])),			// Sample 7 channel index.
-		.sqr3			=	(ADC_SQR3_SQ6_N (config->channels [5])) |			// Sample 6 channel index.
-							(ADC_SQR3_SQ5_N (config->channels [4])) |			// Sample 5 channel index.
-							(ADC_SQR3_SQ4_N (config->channels [3])) |			// Sample 4 channel index.
-							(ADC_SQR3_SQ3_N (config->channels [2])) |			// Sample 3 channel index.
-							(ADC_SQR3_SQ2_N (config->channels [1])) |			// Sample 2 channel index.
-							(ADC_SQR3_SQ1_N (config->channels [0]))				// Sample 1 channel index.
+		.circular		=	circular,
+		.num_channels	=	config->channelCount / adcCount,
+		.end_cb			= 	circular ? analogBlockCallback : NULL,
+		.error_cb		= 	analogErrorCallback,
+		.cr1			=	cr1,												// Watchdog, see above.
+		.cr2			=	cr2,												// Start / trigger, see above.
+		.smpr1			=	smpr1,												// Channel 10 to 18 sample times.
+		.smpr2			=	smpr2,												// Channel 0 to 9 sample times.
+		.htr			=	config->watchdogHigh,								// Watchdog window.
+		.ltr			=	config->watchdogLow,
+		.sqr1			=	sqr [0],											// Samples 13 to 16 channel indices.
+		.sqr2			=	sqr [1],											// Samples 7 to 12 channel indices.
+		.sqr3			=	sqr [2]												// Samples 1 to 6 channel indices.
 	};
 	analog->group = group;
 
+	analog->sampleRate = 0;
+	analogResetStats (analog);
+
+	analog->watchdogTripCount = 0;
+	analog->injectedSweepCount = 0;
+	analog->watchdogArmed = config->watchdogHandler != NULL;
+
+	// Compute the decimation of each oversampled channel. A sum of k samples gains log2 (k) bits, half of which are extra
+	// resolution, the other half is shifted out.
+	analog->oversampling = false;
+	for (uint16_t index = 0; index < config->channelCount; ++index)
+	{
+		analog->oversamplingShifts [index] = 0;
+		analog->accumulators [index] = 0;
+		analog->accumulatorCounts [index] = 0;
+
+		uint16_t factor = config->oversampling [index];
+		if (factor <= 1)
+			continue;
+
+		// Only applicable to continuous / triggered mode, and must be a power of 2, at least a block and at most 256.
+		if (!circular || factor < BLOCK_SWEEP_COUNT || factor > 256 || (factor & (factor - 1)) != 0)
+			return false;
+
+		uint8_t log2 = 0;
+		while ((1u << log2) < factor)
+			++log2;
+
+		analog->oversamplingShifts [index] = (log2 + 1) / 2;
+		analog->oversampling = true;
+	}
+
+	// Reset the state of each filter.
+	analog->filtering = false;
+	for (uint16_t index = 0; index < config->channelCount; ++index)
+	{
+		if (!analogIsFilterValid (&config->filters [index]))
+			return false;
+
+		memset (&analog->filterStates [index], 0, sizeof (analogFilterState_t));
+		if (config->filters [index].type != ANALOG_FILTER_NONE)
+			analog->filtering = true;
+	}
+
 	// Start the ADC with default configuration.
-	return adcStart (analog->config->driver, NULL) == MSG_OK;
+	if (adcStart (analog->config->driver, NULL) != MSG_OK)
+		return false;
+
+	#if STM32_ADC_USE_ADC1
+	if (adcCount > 1)
+		analogStartSimultaneous (analog, adcCount, smpr1, smpr2);
+	#endif // STM32_ADC_USE_ADC1
+
+	// The injected sequence is not written by the driver, so only needs set once.
+	analog->config->driver->adc->JSQR = jsqr;
+
+	if (!circular)
+		return true;
+
+	// Continuous / triggered mode holds the ADC indefinitely.
+	#if ADC_USE_MUTUAL_EXCLUSION
+	adcAcquireBus (analog->config->driver);
+	#endif // ADC_USE_MUTUAL_EXCLUSION
+
+	analog->sweepCount = 0;
+	analog->bufferSweepCount = 0;
+	analog->rateSweepCount = 0;
+	analog->rateTime = chVTGetSystemTime ();
+
+	analog->blockTime = chSysGetRealtimeCounterX ();
+	adcStartConversion (analog->config->driver, &analog->group, analog->dmaBuffer,
+		ANALOG_BUFFER_DEPTH * analog->depthFactor);
+
+	#if HAL_USE_GPT
+	// In triggered mode, the conversion waits for the timer.
+	bool triggerStarted = config->mode != ANALOG_MODE_TRIGGERED || analogStartTimer (config->timer, config->frequency,
+		analog->sweepTime, &analog->timerConfig, &analog->samplePeriod);
+
+	// Same for the injected group, if triggered by a timer.
+	uint32_t injectedTime = (uint64_t) injectedCycles * 1000000000 / ADC_CLOCK_FREQUENCY;
+	bool injectedStarted = config->injectedChannelCount == 0 || config->injectedTimer == NULL || analogStartTimer (
+		config->injectedTimer, config->injectedFrequency, injectedTime, &analog->injectedTimerConfig, &analog->injectedPeriod);
+
+	if (!triggerStarted || !injectedStarted)
+	{
+		// Don't hold the ADC if the conversion cannot run.
+		if (config->mode == ANALOG_MODE_TRIGGERED && triggerStarted)
+			gptStop (config->timer);
+
+		adcStopConversion (analog->config->driver);
+
+		#if ADC_USE_MUTUAL_EXCLUSION
+		adcReleaseBus (analog->config->driver);
+		#endif // ADC_USE_MUTUAL_EXCLUSION
+
+		return false;
+	}
+	#else
+	(void) injectedCycles;
+	#endif // HAL_USE_GPT
+
+	return true;
 }
 
 bool analogSample (analog_t* analog)
 {
+	// Continuous / triggered mode samples without being requested.
+	if (analog->config->mode != ANALOG_MODE_SINGLE)
+		return false;
+
 	// If the API is enabled, lock the ADC's mutex.
 	#if ADC_USE_MUTUAL_EXCLUSION
 	adcAcquireBus (analog->config->driver);
 	#endif // ADC_USE_MUTUAL_EXCLUSION
 
 	// Sample the ADC.
-	if (adcConvert (analog->config->driver, &analog->group, analog->buffer, 1) != MSG_OK)
-		return false;
+	uint32_t start = chSysGetRealtimeCounterX ();
+	msg_t result = adcConvert (analog->config->driver, &analog->group, analog->buffer, analog->depthFactor);
+	uint32_t latency = chSysGetRealtimeCounterX () - start;
 
-	// If the API is enabled, unlock the ADC's mutex.
+	// On failure, restart the driver such that the next conversion can succeed. The error is counted by the error callback.
+	if (result == MSG_OK)
+		analogRecordConversion (analog, latency);
+	else
+		analogRestart (analog);
+
+	// If the API is enabled, unlock the ADC's mutex. This must happen regardless of the result, otherwise other users of
+	// the ADC are blocked indefinitely.
 	#if ADC_USE_MUTUAL_EXCLUSION
 	adcReleaseBus (analog->config->driver);
 	#endif // ADC_USE_MUTUAL_EXCLUSION
 
+	if (result != MSG_OK)
+		return false;
+
 	// Call the conversion event handlers.
+	analogDispatch (analog, analog->buffer);
+	return true;
+}
+
+uint32_t analogGetMeanLatency (analog_t* analog)
+{
+	// The sum cannot be read atomically.
+	osalSysLock ();
+	uint64_t sum = analog->stats.latencySum;
+	uint32_t count = analog->stats.conversionCount;
+	osalSysUnlock ();
+
+	return count != 0 ? sum / count : 0;
+}
+
+void analogResetStats (analog_t* analog)
+{
+	analogStats_t stats =
+	{
+		.conversionCount	= 0,
+		.errorCount			= 0,
+		.overrunCount		= 0,
+		.restartCount		= 0,
+		.latencyMin			= UINT32_MAX,
+		.latencyMax			= 0,
+		.latencySum			= 0
+	};
+
+	osalSysLock ();
+	analog->stats = stats;
+	osalSysUnlock ();
+}
+
+bool analogSampleInjected (analog_t* analog)
+{
+	// Only applicable to a software-triggered injected group, while the ADC is converting the regular group.
+	if (analog->config->injectedChannelCount == 0 || analog->config->driver->state != ADC_ACTIVE)
+		return false;
+
+	#if HAL_USE_GPT
+	if (analog->config->injectedTimer != NULL)
+		return false;
+	#endif // HAL_USE_GPT
+
+	analog->config->driver->adc->CR2 |= ADC_CR2_JSWSTART;
+	return true;
+}
+
+bool analogSetWatchdogWindow (analog_t* analog, adcsample_t low, adcsample_t high)
+{
+	if (analog->config->watchdogHandler == NULL || low > high)
+		return false;
+
+	// Conversions never exceed the 12-bit range, so a wider window is equivalent to one ending at its top.
+	if (high > SAMPLE_MAX)
+		high = SAMPLE_MAX;
+	if (low > SAMPLE_MAX)
+		low = SAMPLE_MAX;
+
+	// The window is read by the ADC's interrupt, when re-arming the watchdog. The conversion group is also updated, such
+	// that a restart of the ADC keeps the new window.
+	osalSysLock ();
+	analog->config->watchdogLow		= low;
+	analog->config->watchdogHigh	= high;
+	analog->group.ltr				= low;
+	analog->group.htr				= high;
+	if (analog->config->driver->state == ADC_ACTIVE)
+	{
+		analog->config->driver->adc->LTR = low;
+		analog->config->driver->adc->HTR = high;
+	}
+	osalSysUnlock ();
+
+	return true;
+}
+
+uint32_t analogConfigureSampleTimes (analogConfig_t* config, uint8_t adcCount, uint32_t* smpr1, uint32_t* smpr2,
+	uint32_t* injectedCycles)
+{
+	// SMPR value of each input, the longest requested.
+	uint8_t sampleTimes [INPUT_COUNT] = { 0 };
+	for (uint16_t index = 0; index < config->channelCount + config->injectedChannelCount; ++index)
+	{
+		// Injected channels follow the regular ones.
+		bool injected = index >= config->channelCount;
+		analogSampleTime_t requested = injected ?
+			config->injectedSampleTimes [index - config->channelCount] : config->sampleTimes [index];
+		adc_channels_num_t channel = injected ?
+			config->injectedChannels [index - config->channelCount] : config->channels [index];
+
+		uint8_t sampleTime = requested == ANALOG_SAMPLE_TIME_DEFAULT ? ADC_SAMPLE_480 : requested - 1;
+		if (channel < INPUT_COUNT && sampleTime > sampleTimes [channel])
+			sampleTimes [channel] = sampleTime;
+	}
+
+	// Inputs 0 to 9 are in SMPR2, inputs 10 to 18 in SMPR1, 3 bits each.
+	*smpr1 = 0;
+	*smpr2 = 0;
+	for (adc_channels_num_t channel = 0; channel < INPUT_COUNT; ++channel)
+	{
+		if (channel < 10)
+			*smpr2 |= (uint32_t) sampleTimes [channel] << (channel * 3);
+		else
+			*smpr1 |= (uint32_t) sampleTimes [channel] << ((channel - 10) * 3);
+	}
+
+	// Each conversion takes its sample time plus the conversion time. The conversions of a rank are simultaneous.
+	uint32_t sweepCycles = 0;
+	for (uint16_t rank = 0; rank < config->channelCount / adcCount; ++rank)
+	{
+		uint32_t rankCycles = 0;
+		for (uint8_t adc = 0; adc < adcCount; ++adc)
+		{
+			adc_channels_num_t channel = config->channels [rank * adcCount + adc];
+			if (channel >= INPUT_COUNT)
+				continue;
+
+			uint32_t cycles = SAMPLE_TIME_CYCLES [sampleTimes [channel]] + CONVERSION_CYCLES;
+			if (cycles > rankCycles)
+				rankCycles = cycles;
+		}
+
+		sweepCycles += rankCycles;
+	}
+
+	*injectedCycles = 0;
+	for (uint16_t index = 0; index < config->injectedChannelCount && index < ANALOG_INJECTED_COUNT; ++index)
+	{
+		adc_channels_num_t channel = config->injectedChannels [index];
+		if (channel < INPUT_COUNT)
+			*injectedCycles += SAMPLE_TIME_CYCLES [sampleTimes [channel]] + CONVERSION_CYCLES;
+	}
+
+	return sweepCycles;
+}
+
+bool analogConfigureInjected (analogConfig_t* config, uint32_t* jsqr, uint32_t* cr1, uint32_t* cr2)
+{
+	*jsqr = 0;
+	*cr1 = 0;
+	*cr2 = 0;
+	uint16_t count = config->injectedChannelCount;
+	if (count == 0)
+		return true;
+
+	if (count > ANALOG_INJECTED_COUNT)
+		return false;
+
+	// A sequence of n conversions occupies the last n of JSQ1 to JSQ4, 5 bits each. The length is n - 1.
+	*jsqr = (uint32_t) (count - 1) << ADC_JSQR_JL_Pos;
+	for (uint16_t index = 0; index < count; ++index)
+	{
+		uint16_t slot = ANALOG_INJECTED_COUNT - count + index;
+		*jsqr |= (uint32_t) config->injectedChannels [index] << (ADC_JSQR_JSQ1_Pos + slot * 5);
+	}
+
+	// Interrupt on the end of the injected sequence.
+	*cr1 = ADC_CR1_JEOCIE;
+
+	#if HAL_USE_GPT
+	// Injected group is started by the rising edge of the timer's TRGO, otherwise by software.
+	if (config->injectedTimer != NULL)
+	{
+		uint32_t jextsel;
+		if ((config->mode == ANALOG_MODE_TRIGGERED && config->injectedTimer == config->timer) ||
+			!analogGetInjectedTriggerSource (config->injectedTimer, &jextsel))
+			return false;
+
+		*cr2 = ADC_CR2_JEXTEN_0 | (jextsel << ADC_CR2_JEXTSEL_Pos);
+	}
+	#endif // HAL_USE_GPT
+
+	return true;
+}
+
+void analogInjectedInterrupt (ADCDriver* driver, uint32_t sr)
+{
+	// The object is only known while the regular group is converting.
+	if ((sr & ADC_SR_JEOC) == 0 || driver->grpp == NULL)
+		return;
+
+	analog_t* analog = analogFromDriver (driver);
+	analogConfig_t* config = analog->config;
+	++analog->injectedSweepCount;
+
+	// Conversion n of the injected sequence is stored in JDRn, regardless of the sequence's length.
+	volatile uint32_t* jdr = &driver->adc->JDR1;
+	for (uint16_t index = 0; index < config->injectedChannelCount; ++index)
+	{
+		adcsample_t sample = jdr [index];
+		analog->injectedBuffer [index] = sample;
+
+		if (config->injectedHandlers [index] != NULL)
+			config->injectedHandlers [index] (config->injectedObjects [index], sample);
+	}
+}
+
+#if STM32_ADC_USE_ADC1
+void analogAdc1IrqHook (uint32_t sr)
+{
+	analogInjectedInterrupt (&ADCD1, sr);
+}
+#endif // STM32_ADC_USE_ADC1
+
+#if STM32_ADC_USE_ADC2
+void analogAdc2IrqHook (uint32_t sr)
+{
+	analogInjectedInterrupt (&ADCD2, sr);
+}
+#endif // STM32_ADC_USE_ADC2
+
+#if STM32_ADC_USE_ADC3
+void analogAdc3IrqHook (uint32_t sr)
+{
+	analogInjectedInterrupt (&ADCD3, sr);
+}
+#endif // STM32_ADC_USE_ADC3
+
+bool analogConfigureWatchdog (analogConfig_t* config, uint8_t adcCount, uint32_t* cr1)
+{
+	*cr1 = 0;
+	if (config->watchdogHandler == NULL)
+		return true;
+
+	if (config->watchdogLow > config->watchdogHigh)
+		return false;
+
+	// Clamp the window to the 12-bit range of the threshold registers.
+	if (config->watchdogHigh > SAMPLE_MAX)
+		config->watchdogHigh = SAMPLE_MAX;
+	if (config->watchdogLow > SAMPLE_MAX)
+		config->watchdogLow = SAMPLE_MAX;
+
+	// Watchdog on the regular group, interrupt on trip.
+	*cr1 = ADC_CR1_AWDEN | ADC_CR1_AWDIE;
+	if (config->watchdogIndex == ANALOG_WATCHDOG_ALL)
+		return true;
+
+	// Guard a single channel, which must be converted by the master.
+	if (config->watchdogIndex >= config->channelCount || config->watchdogIndex % adcCount != 0)
+		return false;
+
+	*cr1 |= ADC_CR1_AWDSGL | ((uint32_t) config->channels [config->watchdogIndex] << ADC_CR1_AWDCH_Pos);
+	return true;
+}
+
+bool analogIsBlockInWindow (analog_t* analog, const adcsample_t* block)
+{
+	analogConfig_t* config = analog->config;
+	for (uint16_t index = 0; index < config->channelCount; ++index)
+	{
+		// Only the master's channels are guarded. A single guarded channel guards every occurrence of its input.
+		bool guarded = index % analog->depthFactor == 0 && (config->watchdogIndex == ANALOG_WATCHDOG_ALL ||
+			config->channels [index] == config->channels [config->watchdogIndex]);
+		if (!guarded)
+			continue;
+
+		for (uint16_t sweep = 0; sweep < BLOCK_SWEEP_COUNT; ++sweep)
+		{
+			adcsample_t sample = block [sweep * config->channelCount + index];
+			if (sample < config->watchdogLow || sample > config->watchdogHigh)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+void analogConfigureSequence (analogConfig_t* config, uint8_t adc, uint8_t adcCount, uint32_t* sqr)
+{
+	// Ranks 1 to 6 are in SQR3, 7 to 12 in SQR2, 13 to 16 in SQR1, 5 bits each.
+	sqr [0] = 0;
+	sqr [1] = 0;
+	sqr [2] = 0;
+	for (uint16_t rank = 0; rank < config->channelCount / adcCount; ++rank)
+	{
+		uint32_t channel = config->channels [rank * adcCount + adc];
+		sqr [2 - rank / 6] |= channel << ((rank % 6) * 5);
+	}
+}
+
+#if STM32_ADC_USE_ADC1
+
+void analogStartSimultaneous (analog_t* analog, uint8_t adcCount, uint32_t smpr1, uint32_t smpr2)
+{
+	ADC_TypeDef* slaves [] = { ADC2, ADC3 };
+	uint16_t rankCount = analog->config->channelCount / adcCount;
+
+	// The slaves are triggered by the master, so only their sequence and sample times are needed.
+	rccEnableADC2 (true);
+	if (adcCount > 2)
+		rccEnableADC3 (true);
+
+	for (uint8_t adc = 1; adc < adcCount; ++adc)
+	{
+		uint32_t sqr [3];
+		analogConfigureSequence (analog->config, adc, adcCount, sqr);
+
+		ADC_TypeDef* slave = slaves [adc - 1];
+		slave->CR1		= ADC_CR1_SCAN;
+		slave->CR2		= ADC_CR2_ADON;
+		slave->SMPR1	= smpr1;
+		slave->SMPR2	= smpr2;
+		slave->SQR1		= sqr [0] | ADC_SQR1_NUM_CH (rankCount);
+		slave->SQR2		= sqr [1];
+		slave->SQR3		= sqr [2];
+	}
+
+	// Regular simultaneous mode, DMA mode 1 (one halfword per request, ADC1, ADC2 then ADC3, meaning each sweep is in the
+	// order of the configuration's sequence). DMA requests continue after the last transfer, as the buffer is circular.
+	uint32_t multi = adcCount == 2 ? MULTI_DUAL_REGULAR_SIMULTANEOUS : MULTI_TRIPLE_REGULAR_SIMULTANEOUS;
+	ADC->CCR = (ADC->CCR & ~(ADC_CCR_MULTI | ADC_CCR_DMA | ADC_CCR_DDS)) | (multi << ADC_CCR_MULTI_Pos) | ADC_CCR_DMA_0 |
+		ADC_CCR_DDS;
+
+	// The master's DMA stream reads the common data register rather than the master's.
+	dmaStreamSetPeripheral (analog->config->driver->dmastp, &ADC->CDR);
+}
+
+#endif // STM32_ADC_USE_ADC1
+
+#if HAL_USE_GPT
+
+bool analogStartTimer (GPTDriver* timer, uint32_t frequency, uint32_t conversionTime, GPTConfig* timerConfig,
+	uint32_t* period)
+{
+	// The period must be a whole number of counts that fits in a 16-bit timer, and must fit a conversion.
+	if (frequency == 0 || frequency > TRIGGER_COUNTER_FREQUENCY)
+		return false;
+
+	uint32_t interval = TRIGGER_COUNTER_FREQUENCY / frequency;
+	if (interval > UINT16_MAX || (uint64_t) interval * (1000000000 / TRIGGER_COUNTER_FREQUENCY) <= conversionTime)
+		return false;
+
+	*period = interval * (1000000 / TRIGGER_COUNTER_FREQUENCY);
+
+	// Generate TRGO on each update event (MMS = 010).
+	GPTConfig config =
+	{
+		.frequency	= TRIGGER_COUNTER_FREQUENCY,
+		.callback	= NULL,
+		.cr2		= TIM_CR2_MMS_1,
+		.dier		= 0
+	};
+	*timerConfig = config;
+
+	if (gptStart (timer, timerConfig) != MSG_OK)
+		return false;
+
+	gptStartContinuous (timer, interval);
+	return true;
+}
+
+bool analogGetTriggerSource (GPTDriver* timer, uint32_t* extsel)
+{
+	// Only TIM2, TIM3 and TIM8 have a TRGO trigger of the regular group (RM0090 table 69).
+	#if STM32_GPT_USE_TIM2
+	if (timer == &GPTD2)
+	{
+		*extsel = 0b0110;
+		return true;
+	}
+	#endif // STM32_GPT_USE_TIM2
+
+	#if STM32_GPT_USE_TIM3
+	if (timer == &GPTD3)
+	{
+		*extsel = 0b1000;
+		return true;
+	}
+	#endif // STM32_GPT_USE_TIM3
+
+	#if STM32_GPT_USE_TIM8
+	if (timer == &GPTD8)
+	{
+		*extsel = 0b1110;
+		return true;
+	}
+	#endif // STM32_GPT_USE_TIM8
+
+	(void) timer;
+	(void) extsel;
+	return false;
+}
+
+bool analogGetInjectedTriggerSource (GPTDriver* timer, uint32_t* jextsel)
+{
+	// Only TIM1, TIM2, TIM4 and TIM5 have a TRGO trigger of the injected group (RM0090 table 70).
+	#if STM32_GPT_USE_TIM1
+	if (timer == &GPTD1)
+	{
+		*jextsel = 0b0001;
+		return true;
+	}
+	#endif // STM32_GPT_USE_TIM1
+
+	#if STM32_GPT_USE_TIM2
+	if (timer == &GPTD2)
+	{
+		*jextsel = 0b0011;
+		return true;
+	}
+	#endif // STM32_GPT_USE_TIM2
+
+	#if STM32_GPT_USE_TIM4
+	if (timer == &GPTD4)
+	{
+		*jextsel = 0b1001;
+		return true;
+	}
+	#endif // STM32_GPT_USE_TIM4
+
+	#if STM32_GPT_USE_TIM5
+	if (timer == &GPTD5)
+	{
+		*jextsel = 0b1011;
+		return true;
+	}
+	#endif // STM32_GPT_USE_TIM5
+
+	(void) timer;
+	(void) jextsel;
+	return false;
+}
+
+#endif // HAL_USE_GPT
+
+void analogRecordConversion (analog_t* analog, uint32_t latency)
+{
+	++analog->stats.conversionCount;
+	analog->stats.latencySum += latency;
+
+	if (latency < analog->stats.latencyMin)
+		analog->stats.latencyMin = latency;
+
+	if (latency > analog->stats.latencyMax)
+		analog->stats.latencyMax = latency;
+}
+
+void analogRestart (analog_t* analog)
+{
+	ADCDriver* driver = analog->config->driver;
+	++analog->stats.restartCount;
+
+	adcStop (driver);
+	if (adcStart (driver, NULL) != MSG_OK)
+		return;
+
+	// Starting the ADC resets the common configuration, but not the injected sequence. Note the injected group is not
+	// applicable to single mode, but the slaves of simultaneous mode are.
+	#if STM32_ADC_USE_ADC1
+	if (analog->depthFactor > 1)
+		analogStartSimultaneous (analog, analog->depthFactor, analog->group.smpr1, analog->group.smpr2);
+	#endif // STM32_ADC_USE_ADC1
+}
+
+analog_t* analogFromDriver (ADCDriver* driver)
+{
+	// The conversion group is a member of the analog_t.
+	return (analog_t*) ((uintptr_t) driver->grpp - offsetof (analog_t, group));
+}
+
+void analogDispatch (analog_t* analog, const adcsample_t* sweep)
+{
 	for (adc_channels_num_t index = 0; index < analog->config->channelCount; ++index)
+	{
+		adcsample_t sample = analog->filtering ? analogFilter (analog, index, sweep [index]) : sweep [index];
+		analog->buffer [index] = sample;
+
 		if (analog->config->handlers [index] != NULL)
-			analog->config->handlers [index] (analog->config->objects [index], analog->buffer [index]);
+			analog->config->handlers [index] (analog->config->objects [index], sample);
+	}
 
-	return true;
+	if (analog->config->blockHandler != NULL)
+		analog->config->blockHandler (analog->config->blockObject, analog->buffer, analog->config->channelCount);
+}
+
+void analogBlockCallback (ADCDriver* driver)
+{
+	analog_t* analog = analogFromDriver (driver);
+
+	// The half transfer completes the first block, the full transfer the second.
+	uint16_t sweepEnd = adcIsBufferComplete (driver) ? ANALOG_BUFFER_DEPTH : BLOCK_SWEEP_COUNT;
+
+	// The next block starts as this one completes.
+	uint32_t blockTime = chSysGetRealtimeCounterX ();
+	analogRecordConversion (analog, blockTime - analog->blockTime);
+	analog->blockTime = blockTime;
+
+	// Measure the sample rate.
+	analog->sweepCount += BLOCK_SWEEP_COUNT;
+	analog->bufferSweepCount = sweepEnd % ANALOG_BUFFER_DEPTH;
+	analog->rateSweepCount += BLOCK_SWEEP_COUNT;
+	systime_t timeCurrent = chVTGetSystemTimeX ();
+	sysinterval_t elapsed = chTimeDiffX (analog->rateTime, timeCurrent);
+	if (elapsed >= SAMPLE_RATE_PERIOD)
+	{
+		analog->sampleRate = (uint64_t) analog->rateSweepCount * CH_CFG_ST_FREQUENCY / elapsed;
+		analog->rateSweepCount = 0;
+		analog->rateTime = timeCurrent;
+	}
+
+	uint16_t channelCount = analog->config->channelCount;
+	const adcsample_t* block = analog->dmaBuffer + (sweepEnd - BLOCK_SWEEP_COUNT) * channelCount;
+
+	// Re-arm the watchdog once the guarded channel is back within the window. The flag is cleared first, as it is set by
+	// every conversion outside the window, even while disarmed.
+	if (analog->config->watchdogHandler != NULL && !analog->watchdogArmed && analogIsBlockInWindow (analog, block))
+	{
+		analog->watchdogArmed = true;
+		analog->group.cr1 |= ADC_CR1_AWDEN | ADC_CR1_AWDIE;
+		driver->adc->SR = ~ADC_SR_AWD;
+		driver->adc->CR1 |= ADC_CR1_AWDEN | ADC_CR1_AWDIE;
+	}
+
+	// Dispatch the block. The DMA is filling the other block in the meantime.
+	if (analog->filtering)
+		analogFilterBlock (analog, block);
+
+	if (analog->oversampling)
+		analogDispatchOversampled (analog, block);
+	else
+		analogDispatch (analog, block + (BLOCK_SWEEP_COUNT - 1) * channelCount);
+}
+
+bool analogIsFilterValid (const analogFilterConfig_t* filter)
+{
+	switch (filter->type)
+	{
+	case ANALOG_FILTER_NONE:
+		return true;
+
+	case ANALOG_FILTER_IIR:
+		return filter->order >= 1 && filter->order <= ANALOG_FILTER_ORDER_MAX && filter->a != NULL && filter->b != NULL &&
+			filter->a [0] != 0.0f;
+
+	case ANALOG_FILTER_MOVING_AVERAGE:
+	case ANALOG_FILTER_MEDIAN:
+		return filter->window >= 1 && filter->window <= ANALOG_FILTER_WINDOW_MAX;
+
+	default:
+		return false;
+	}
+}
+
+adcsample_t analogFilter (analog_t* analog, uint16_t index, adcsample_t sample)
+{
+	const analogFilterConfig_t* filter = &analog->config->filters [index];
+	analogFilterState_t* state = &analog->filterStates [index];
+
+	switch (filter->type)
+	{
+	case ANALOG_FILTER_IIR:
+	{
+		// Start from the steady state of the first sample, w = x / (a_0 + ... + a_n), rather than from 0.
+		if (state->count == 0)
+		{
+			float aSum = 0;
+			for (uint8_t i = 0; i <= filter->order; ++i)
+				aSum += filter->a [i];
+
+			for (uint8_t i = 0; i <= filter->order; ++i)
+				state->w [i] = aSum != 0.0f ? sample / aSum : 0.0f;
+
+			state->count = 1;
+		}
+
+		float y = transferFunctionFilter (sample, filter->a, filter->b, state->w, filter->order);
+
+		// Round and saturate to the range of a sample.
+		if (y <= 0.0f)
+			return 0;
+		if (y >= UINT16_MAX)
+			return UINT16_MAX;
+		return (adcsample_t) (y + 0.5f);
+	}
+
+	case ANALOG_FILTER_MOVING_AVERAGE:
+	{
+		// Replace the oldest sample in the sum.
+		if (state->count == filter->window)
+			state->sum -= state->history [state->head];
+		else
+			++state->count;
+
+		state->history [state->head] = sample;
+		state->sum += sample;
+		state->head = (state->head + 1) % filter->window;
+
+		return (state->sum + state->count / 2) / state->count;
+	}
+
+	case ANALOG_FILTER_MEDIAN:
+	{
+		if (state->count < filter->window)
+			++state->count;
+
+		state->history [state->head] = sample;
+		state->head = (state->head + 1) % filter->window;
+
+		// Insertion sort a copy of the history, the window is small.
+		adcsample_t sorted [ANALOG_FILTER_WINDOW_MAX];
+		for (uint8_t i = 0; i < state->count; ++i)
+		{
+			adcsample_t value = state->history [i];
+			uint8_t j = i;
+			for (; j > 0 && sorted [j - 1] > value; --j)
+				sorted [j] = sorted [j - 1];
+			sorted [j] = value;
+		}
+
+		// For an even count, average the middle two.
+		uint8_t middle = state->count / 2;
+		if (state->count % 2 == 0)
+			return ((uint32_t) sorted [middle - 1] + sorted [middle] + 1) / 2;
+		return sorted [middle];
+	}
+
+	default:
+		return sample;
+	}
+}
+
+void analogFilterBlock (analog_t* analog, const adcsample_t* block)
+{
+	analogConfig_t* config = analog->config;
+	for (uint16_t index = 0; index < config->channelCount; ++index)
+	{
+		// Oversampled channels are only filtered once decimated.
+		if (config->filters [index].type == ANALOG_FILTER_NONE || config->oversampling [index] > 1)
+			continue;
+
+		for (uint16_t sweep = 0; sweep < BLOCK_SWEEP_COUNT - 1; ++sweep)
+			analogFilter (analog, index, block [sweep * config->channelCount + index]);
+	}
+}
+
+void analogSumBlock (const adcsample_t* block, uint16_t channelCount, uint32_t* sums)
+{
+	#if defined (__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+	if (channelCount % 2 == 0)
+	{
+		// Sum pairs of channels using the halfword lanes of a word, each lane holding at most BLOCK_SWEEP_COUNT * 4095, so
+		// cannot overflow.
+		for (uint16_t pair = 0; pair < channelCount / 2; ++pair)
+		{
+			uint32_t lanes = 0;
+			for (uint16_t sweep = 0; sweep < BLOCK_SWEEP_COUNT; ++sweep)
+			{
+				uint32_t word;
+				memcpy (&word, block + sweep * channelCount + pair * 2, sizeof (word));
+				lanes = __UADD16 (lanes, word);
+			}
+
+			sums [pair * 2]		= lanes & 0xFFFF;
+			sums [pair * 2 + 1]	= lanes >> 16;
+		}
+
+		return;
+	}
+	#endif // __ARM_FEATURE_DSP
+
+	for (uint16_t index = 0; index < channelCount; ++index)
+	{
+		uint32_t sum = 0;
+		for (uint16_t sweep = 0; sweep < BLOCK_SWEEP_COUNT; ++sweep)
+			sum += block [sweep * channelCount + index];
+
+		sums [index] = sum;
+	}
+}
+
+void analogDispatchOversampled (analog_t* analog, const adcsample_t* block)
+{
+	analogConfig_t* config = analog->config;
+	const adcsample_t* sweep = block + (BLOCK_SWEEP_COUNT - 1) * config->channelCount;
+
+	uint32_t sums [ANALOG_CHANNEL_COUNT];
+	analogSumBlock (block, config->channelCount, sums);
+
+	for (adc_channels_num_t index = 0; index < config->channelCount; ++index)
+	{
+		adcsample_t sample = sweep [index];
+
+		if (config->oversampling [index] > 1)
+		{
+			// Accumulate until the factor is reached, then decimate.
+			analog->accumulators [index] += sums [index];
+			analog->accumulatorCounts [index] += BLOCK_SWEEP_COUNT;
+			if (analog->accumulatorCounts [index] < config->oversampling [index])
+				continue;
+
+			sample = analog->accumulators [index] >> analog->oversamplingShifts [index];
+			analog->accumulators [index] = 0;
+			analog->accumulatorCounts [index] = 0;
+		}
+
+		if (analog->filtering)
+			sample = analogFilter (analog, index, sample);
+
+		analog->buffer [index] = sample;
+
+		if (config->handlers [index] != NULL)
+			config->handlers [index] (config->objects [index], sample);
+	}
+
+	// Channels still accumulating keep their previous sample.
+	if (config->blockHandler != NULL)
+		config->blockHandler (config->blockObject, analog->buffer, config->channelCount);
+}
+
+void analogErrorCallback (ADCDriver* driver, adcerror_t error)
+{
+	analog_t* analog = analogFromDriver (driver);
+
+	// A watchdog trip is not a failed conversion.
+	if (error != ADC_ERR_AWD)
+		++analog->stats.errorCount;
+
+	if (error == ADC_ERR_OVERFLOW)
+		++analog->stats.overrunCount;
+
+	if (error == ADC_ERR_AWD)
+	{
+		// Disarm the watchdog until the channel is back within the window, otherwise it would trip on every conversion.
+		// The watchdog is disabled entirely, as its flag would otherwise be reported along with the next overrun.
+		++analog->watchdogTripCount;
+		analog->watchdogArmed = false;
+		analog->group.cr1 &= ~(ADC_CR1_AWDEN | ADC_CR1_AWDIE);
+		analog->config->watchdogHandler (analog->config->watchdogObject);
+
+		// The conversion is restarted from the beginning of the buffer, discarding the partial block. Its sweeps (including
+		// the interrupted one) are still counted, such that the timestamps of later sweeps remain correct. The DMA's
+		// remaining transfer count gives the number of samples converted in the current pass over the buffer. Note the
+		// watchdog is only applicable to continuous / triggered mode.
+		uint32_t channelCount = analog->config->channelCount;
+		uint32_t converted = ANALOG_BUFFER_DEPTH * channelCount - dmaStreamGetTransactionSize (driver->dmastp);
+		uint32_t sweeps = (converted + channelCount - 1) / channelCount;
+		if (sweeps > analog->bufferSweepCount)
+			analog->sweepCount += sweeps - analog->bufferSweepCount;
+	}
+
+	// In single mode, the driver wakes the caller with the error, which restarts the driver.
+	if (analog->config->mode == ANALOG_MODE_SINGLE)
+		return;
+
+	// Restart the conversion.
+	analog->bufferSweepCount = 0;
+	analog->blockTime = chSysGetRealtimeCounterX ();
+	osalSysLockFromISR ();
+	adcStartConversionI (driver, &analog->group, analog->dmaBuffer, ANALOG_BUFFER_DEPTH * analog->depthFactor);
+	osalSysUnlockFromISR ();
 }
\ No newline at end of file
@@ -8,6 +8,66 @@
 //
 // Description: Wrapper for the ChibiOS ADC driver. This object is intended to wrap access to the ADC peripheral such that
 //   multiple unrelated objects may share access.
+//
+//   In single mode, the channels are sampled by calling analogSample, which blocks the caller until the conversion is
+//   complete. In continuous mode, the ADC converts continuously into a circular DMA buffer of multiple sweeps, split into two
+//   blocks. Each time a block is completed (half / full transfer), the latest sample of each channel is dispatched to the
+//   handlers, from the ADC's interrupt, while the DMA fills the other block. Note the ADC is held for the entirety of
+//   continuous mode, so it cannot be shared with other analog_t objects.
+//
+//   Triggered mode is identical to continuous mode, except each sweep is started by a timer's TRGO event rather than the
+//   previous sweep, meaning the channels are sampled at a fixed frequency, independent of software. The timestamp of each
+//   sweep is derived from the number of sweeps completed (see analog_t::sweepCount), such that downstream digital filters
+//   (ex. transfer_function.h) get a constant sample period.
+//
+//   In continuous / triggered mode, channels may be oversampled by a power of 2 from 4 to 256. The samples of an oversampled
+//   channel are summed over as many sweeps, two channels at a time using halfword-lane additions, then decimated, the
+//   handler being called once per sum. The decimated sample has 12 + log2 (k) / 2 (rounded down) bits of resolution, for an
+//   oversampling factor of k (ex. 16-bit for 256x), so the handler's object must be configured for the oversampled range
+//   (ex. the sample bounds of a linear_sensor.h object).
+//
+//   ADC1 may use ADC2 (and ADC3) in regular simultaneous mode, the ADCs converting their sequences in lockstep through the
+//   master's DMA stream. Entry i of the sequence is converted by ADC (i % n) + 1 at rank i / n, for n ADCs, meaning
+//   consecutive entries are sampled at the same instant (ex. redundant sensors), and a sweep takes a fraction of the time.
+//   The ADCs are exclusively used by this object. Entries of the same rank should have the same sample time.
+//
+//   Each channel may be filtered (IIR, moving average or median) before being dispatched, such that every consumer of the
+//   channel sees the same filtered signal. In continuous / triggered mode, every sweep of a block is fed through the
+//   filter, so the filter's sample period is the sweep period, not the block period. Oversampled channels are filtered
+//   after decimation. Injected channels are not filtered.
+//
+//   Along with (or instead of) the per-channel handlers, a block handler may be given the latest sample of every channel
+//   in one call, each time the channels are dispatched. This allows batch processing of the channels (see
+//   linearSensorArrayUpdate), rather than an indirect call per channel per sample.
+//
+//   In continuous / triggered mode, the ADC's analog watchdog may guard one channel (or every channel) against a window of
+//   samples, without any CPU involvement. A conversion outside the window calls the watchdog handler from the ADC's
+//   interrupt, meaning a shorted / open sensor is detected within a sweep. The watchdog is then disarmed (as it would trip
+//   on every conversion), and re-armed once every sample of the guarded channel in a block is back within the window. In
+//   simultaneous mode, only the channels converted by ADC1 can be guarded. A trip stops the conversion, which is restarted
+//   from the beginning of the buffer, the partial block being discarded (its sweeps are still counted, see sweepCount).
+//
+//   In continuous / triggered mode, up to 4 channels may be sampled by the ADC's injected group. Injected conversions are
+//   triggered independently of the regular sweep (by a timer, or by software), and preempt it, the current regular
+//   conversion being resumed after the injected ones. This means critical signals (ex. pedals) do not wait for a long sweep
+//   of slow signals (ex. thermistors). The injected handlers are called from the ADC's interrupt, which the ChibiOS ADC
+//   driver does not handle, so the interrupt must be forwarded through the driver's hook, in mcuconf.h:
+//
+//     #define STM32_ADC_ADC1_IRQ_HOOK { void analogAdc1IrqHook (uint32_t sr); analogAdc1IrqHook (sr); }
+//
+//   The injected group is not available in simultaneous mode.
+//
+//   Conversion errors are recovered from automatically. In single mode, a failed conversion restarts the driver (the next
+//   call to analogSample converts as normal). In continuous / triggered mode, the conversion is restarted from the ADC's
+//   interrupt. Statistics of the conversions (see analogStats_t) are kept per object, the latencies being measured by the
+//   kernel's realtime counter (chSysGetRealtimeCounterX, the DWT cycle counter on this port). This module does not enable
+//   the counter itself, as the debug unit may be owned by the application or a debugger: the port enables it in
+//   chSysInit. If it is disabled afterwards, the latencies read as 0.
+//
+//   The sample time is configured per channel. A sweep takes the sum of each channel's sample time plus 12 cycles (the
+//   conversion time) of the ADC's clock. Low-impedance sources (ex. current sensors) can use short sample times, while
+//   high-impedance sources (ex. thermistors) need long ones. A channel may also appear multiple times in the sequence to
+//   sample it more often than others.
 
 // Includes -------------------------------------------------------------------------------------------------------------------
 
@@ -19,39 +79,337 @@
 /// @brief The maximum number of channels in an ADC conversion group.
 #define ANALOG_CHANNEL_COUNT 16
 
+/// @brief The maximum order of a channel's IIR filter (2 being a biquad).
+#define ANALOG_FILTER_ORDER_MAX 2
+
+/// @brief The maximum window of a channel's moving average / median filter, in samples.
+#define ANALOG_FILTER_WINDOW_MAX 8
+
+/// @brief The maximum number of channels in the injected group.
+#define ANALOG_INJECTED_COUNT 4
+
+/// @brief Value of @c analogConfig_t::watchdogIndex guarding every channel with the analog watchdog.
+#define ANALOG_WATCHDOG_ALL 0xFFFF
+
+/// @brief The number of sweeps (samples of every channel) in the circular buffer of continuous / triggered mode. Each half
+/// of the buffer is a block.
+#define ANALOG_BUFFER_DEPTH 8
+
 // Datatypes ------------------------------------------------------------------------------------------------------------------
 
 typedef void (analogHandler_t) (void* object, adcsample_t sample);
 
+typedef void (analogBlockHandler_t) (void* object, const adcsample_t* samples, uint16_t count);
+
+typedef void (analogWatchdogHandler_t) (void* object);
+
+/// @brief The sample time of a channel, in ADC clock cycles.
+typedef enum
+{
+	/// @brief The default sample time, 480 cycles. Suitable for any source impedance.
+	ANALOG_SAMPLE_TIME_DEFAULT	= 0,
+	ANALOG_SAMPLE_TIME_3		= 1,
+	ANALOG_SAMPLE_TIME_15		= 2,
+	ANALOG_SAMPLE_TIME_28		= 3,
+	ANALOG_SAMPLE_TIME_56		= 4,
+	ANALOG_SAMPLE_TIME_84		= 5,
+	ANALOG_SAMPLE_TIME_112		= 6,
+	ANALOG_SAMPLE_TIME_144		= 7,
+	ANALOG_SAMPLE_TIME_480		= 8
+} analogSampleTime_t;
+
+typedef enum
+{
+	/// @brief The channel is not filtered.
+	ANALOG_FILTER_NONE				= 0,
+
+	/// @brief Discrete-time transfer function, see transfer_function.h. The filter's state is initialized to the steady
+	/// state of the first sample.
+	ANALOG_FILTER_IIR				= 1,
+
+	/// @brief Average of the last N samples.
+	ANALOG_FILTER_MOVING_AVERAGE	= 2,
+
+	/// @brief Median of the last N samples, rejecting impulse noise.
+	ANALOG_FILTER_MEDIAN			= 3
+} analogFilterType_t;
+
+typedef struct
+{
+	/// @brief The type of filter to use.
+	analogFilterType_t type;
+
+	/// @brief IIR only, the order of the transfer function, from 1 to @c ANALOG_FILTER_ORDER_MAX .
+	uint8_t order;
+
+	/// @brief Moving average / median only, the number of samples to filter over, from 1 to @c ANALOG_FILTER_WINDOW_MAX .
+	uint8_t window;
+
+	/// @brief IIR only, the coefficients of the denominator of the transfer function, length @c order + 1.
+	float* a;
+
+	/// @brief IIR only, the coefficients of the numerator of the transfer function, length @c order + 1.
+	float* b;
+} analogFilterConfig_t;
+
+typedef struct
+{
+	/// @brief IIR only, the state vector.
+	float w [ANALOG_FILTER_ORDER_MAX + 1];
+
+	/// @brief Moving average / median only, the last samples, circular.
+	adcsample_t history [ANALOG_FILTER_WINDOW_MAX];
+
+	/// @brief Moving average only, the sum of the history.
+	uint32_t sum;
+
+	/// @brief Moving average / median only, the index of the oldest sample in the history.
+	uint8_t head;
+
+	/// @brief The number of samples filtered, saturating at the window.
+	uint8_t count;
+} analogFilterState_t;
+
+typedef enum
+{
+	/// @brief The channels are sampled on request, see @c analogSample .
+	ANALOG_MODE_SINGLE		= 0,
+
+	/// @brief The channels are sampled continuously, the handlers being called from the ADC's interrupt.
+	ANALOG_MODE_CONTINUOUS	= 1,
+
+	/// @brief The channels are sampled at the frequency of a timer, the handlers being called from the ADC's interrupt.
+	/// Requires the GPT driver.
+	ANALOG_MODE_TRIGGERED	= 2
+} analogMode_t;
+
 typedef struct
 {
 	/// @brief The ADC peripheral to use.
 	ADCDriver* driver;
 
+	/// @brief The acquisition mode to use.
+	analogMode_t mode;
+
+	/// @brief The number of ADCs to convert the sequence with simultaneously, 2 (ADC1 and ADC2) or 3 (ADC1, ADC2 and ADC3).
+	/// Use 0 or 1 for a single ADC. Requires @c driver to be ADC1 and @c channelCount to be a multiple of this.
+	uint8_t adcCount;
+
 	/// @brief The ADC channels to sample, in order. @note Un-used channels must be initialized to @c ADC_CHANNEL_NULL .
 	adc_channels_num_t channels [ANALOG_CHANNEL_COUNT];
 
 	/// @brief The number of ADC channels to sample.
 	uint16_t channelCount;
 
-	/// @brief Event handler for each channel's sample being completed.
+	/// @brief The sample time of each channel. If a channel appears multiple times in the sequence, the longest of its
+	/// sample times is used.
+	analogSampleTime_t sampleTimes [ANALOG_CHANNEL_COUNT];
+
+	/// @brief The oversampling factor of each channel, a power of 2 from 4 to 256, or 0 for no oversampling. Only applicable
+	/// to continuous / triggered mode.
+	uint16_t oversampling [ANALOG_CHANNEL_COUNT];
+
+	/// @brief The filter of each channel, applied before the channel is dispatched. Zero-initialize for no filter.
+	analogFilterConfig_t filters [ANALOG_CHANNEL_COUNT];
+
+	/// @brief Event handler for each channel's sample being completed. @note In continuous / triggered mode, handlers are
+	/// called from the ADC's interrupt, so must be ISR-safe.
 	analogHandler_t* handlers [ANALOG_CHANNEL_COUNT];
 
 	/// @brief Subscriber to each channel's event handler, passed as @c object of the handler.
 	void* objects [ANALOG_CHANNEL_COUNT];
+
+	/// @brief Event handler for the channels being dispatched, given the latest sample of every channel, in sequence order.
+	/// Called after the per-channel handlers, use @c NULL to disable. @note In continuous / triggered mode, this is called
+	/// from the ADC's interrupt, so must be ISR-safe.
+	analogBlockHandler_t* blockHandler;
+
+	/// @brief Subscriber to the block handler, passed as @c object of the handler.
+	void* blockObject;
+
+	/// @brief The ADC channels of the injected group, in order. Only applicable to continuous / triggered mode.
+	adc_channels_num_t injectedChannels [ANALOG_INJECTED_COUNT];
+
+	/// @brief The number of ADC channels of the injected group, 0 to disable it.
+	uint16_t injectedChannelCount;
+
+	/// @brief The sample time of each injected channel. Note sample times are per input, shared with the regular group, see
+	/// @c sampleTimes .
+	analogSampleTime_t injectedSampleTimes [ANALOG_INJECTED_COUNT];
+
+	/// @brief Event handler for each injected channel's sample being completed, called from the ADC's interrupt.
+	analogHandler_t* injectedHandlers [ANALOG_INJECTED_COUNT];
+
+	/// @brief Subscriber to each injected channel's event handler, passed as @c object of the handler.
+	void* injectedObjects [ANALOG_INJECTED_COUNT];
+
+	/// @brief Handler for the analog watchdog tripping, called from the ADC's interrupt. Use @c NULL to disable the watchdog.
+	/// Only applicable to continuous / triggered mode.
+	analogWatchdogHandler_t* watchdogHandler;
+
+	/// @brief Subscriber to the watchdog's handler, passed as @c object of the handler.
+	void* watchdogObject;
+
+	/// @brief The index of the channel (in the sequence) guarded by the watchdog, or @c ANALOG_WATCHDOG_ALL for every channel.
+	/// If the channel's input appears multiple times in the sequence, every occurrence is guarded.
+	uint16_t watchdogIndex;
+
+	/// @brief The lowest sample (inclusive) not tripping the watchdog.
+	adcsample_t watchdogLow;
+
+	/// @brief The highest sample (inclusive) not tripping the watchdog. Values above the 12-bit range are clamped to it.
+	adcsample_t watchdogHigh;
+
+	#if HAL_USE_GPT
+	/// @brief The timer triggering conversions, only applicable to triggered mode. Must be TIM2, TIM3 or TIM8 (the timers
+	/// whose TRGO can trigger the ADC), and is exclusively used by this object.
+	GPTDriver* timer;
+
+	/// @brief The frequency to sample the channels at, in Hz, only applicable to triggered mode. The sample period is rounded
+	/// down to a whole number of microseconds, and must be longer than a sweep and at most 65535 us (about 16 Hz).
+	uint32_t frequency;
+
+	/// @brief The timer triggering the injected group, or @c NULL to trigger it by software (see @c analogSampleInjected ).
+	/// Must be TIM1, TIM2, TIM4 or TIM5 (the timers whose TRGO can trigger the injected group), and is exclusively used by
+	/// this object.
+	GPTDriver* injectedTimer;
+
+	/// @brief The frequency to sample the injected channels at, in Hz. Same constraints as @c frequency .
+	uint32_t injectedFrequency;
+	#endif // HAL_USE_GPT
 } analogConfig_t;
 
+/**
+ * @brief Statistics of the conversions of an analog_t. In continuous / triggered mode, a conversion is a block.
+ */
+typedef struct
+{
+	/// @brief The number of conversions completed.
+	uint32_t conversionCount;
+
+	/// @brief The number of conversions that failed, including overruns.
+	uint32_t errorCount;
+
+	/// @brief The number of times the ADC overran (a conversion was lost as the DMA could not keep up).
+	uint32_t overrunCount;
+
+	/// @brief The number of times the driver was restarted to recover from a failed conversion (single mode only).
+	uint32_t restartCount;
+
+	/// @brief The shortest latency of a conversion, in CPU cycles. In single mode, this is the duration of the conversion,
+	/// in continuous / triggered mode, the time between a block's start and its completion.
+	uint32_t latencyMin;
+
+	/// @brief The longest latency of a conversion, in CPU cycles.
+	uint32_t latencyMax;
+
+	/// @brief The sum of the latencies of the conversions, in CPU cycles, see @c analogGetMeanLatency .
+	uint64_t latencySum;
+} analogStats_t;
+
+/**
+ * @brief Wrapper for an ADC peripheral.
+ * @note In continuous / triggered mode, the DMA writes to @c dmaBuffer directly, so this object must be placed in
+ * DMA-accessible memory (not the core-coupled memory).
+ */
 typedef struct
 {
 	analogConfig_t*		config;
 	ADCConversionGroup	group;
+
+	/// @brief The latest sample of each channel.
 	adcsample_t			buffer [ANALOG_CHANNEL_COUNT];
+
+	/// @brief The number of ADCs converting the sequence, by which the depth of each conversion is multiplied (as the
+	/// conversion group only describes the master's sequence).
+	uint8_t				depthFactor;
+
+	/// @brief The number of ADC clock cycles taken by each sweep of the channels, computed at init.
+	uint32_t			sweepCycles;
+
+	/// @brief The duration of each sweep of the channels, in nanoseconds, computed at init.
+	uint32_t			sweepTime;
+
+	/// @brief The circular buffer of continuous / triggered mode, @c ANALOG_BUFFER_DEPTH sweeps of the channels.
+	adcsample_t			dmaBuffer [ANALOG_BUFFER_DEPTH * ANALOG_CHANNEL_COUNT];
+
+	/// @brief In continuous / triggered mode, the number of sweeps completed per second, as of the last measurement.
+	uint32_t			sampleRate;
+
+	/// @brief Statistics of the conversions. Modified from the ADC's interrupt in continuous / triggered mode.
+	analogStats_t		stats;
+
+	/// @brief In continuous / triggered mode, the cycle count of the start of the current block.
+	uint32_t			blockTime;
+
+	/// @brief The latest sample of each injected channel.
+	adcsample_t			injectedBuffer [ANALOG_INJECTED_COUNT];
+
+	/// @brief The number of injected sequences completed.
+	uint32_t			injectedSweepCount;
+
+	/// @brief The number of times the analog watchdog tripped.
+	uint32_t			watchdogTripCount;
+
+	/// @brief Indicates the analog watchdog is armed. Cleared when it trips, set once the guarded channel is back within the
+	/// window.
+	bool				watchdogArmed;
+
+	/// @brief In continuous / triggered mode, the number of sweeps completed. During a handler call, @c sweepCount - 1 is
+	/// the index of the sweep being dispatched. Sweeps discarded by a watchdog trip are counted, despite not being
+	/// dispatched.
+	uint32_t			sweepCount;
+
+	/// @brief In continuous / triggered mode, the number of sweeps of the current pass over @c dmaBuffer already counted by
+	/// @c sweepCount .
+	uint16_t			bufferSweepCount;
+
+	#if HAL_USE_GPT
+	/// @brief In triggered mode, the sample period, in microseconds. The timestamp of sweep @c n is @c n * @c samplePeriod ,
+	/// relative to the first sweep. Note sweeps lost to an overrun are not counted (those discarded by a watchdog trip
+	/// are).
+	uint32_t			samplePeriod;
+
+	/// @brief In triggered mode, the configuration of the timer.
+	GPTConfig			timerConfig;
+
+	/// @brief If the injected group is triggered by a timer, the sample period of the injected channels, in microseconds.
+	uint32_t			injectedPeriod;
+
+	/// @brief If the injected group is triggered by a timer, the configuration of the timer.
+	GPTConfig			injectedTimerConfig;
+	#endif // HAL_USE_GPT
+
+	/// @brief Indicates any channel is oversampled.
+	bool				oversampling;
+
+	/// @brief The sum of the samples of each oversampled channel since its last decimation.
+	uint32_t			accumulators [ANALOG_CHANNEL_COUNT];
+
+	/// @brief The number of samples in each channel's accumulator.
+	uint16_t			accumulatorCounts [ANALOG_CHANNEL_COUNT];
+
+	/// @brief The right shift of each oversampled channel's sum, discarding the bits beyond the extra resolution.
+	uint8_t				oversamplingShifts [ANALOG_CHANNEL_COUNT];
+
+	/// @brief Indicates any channel is filtered.
+	bool				filtering;
+
+	/// @brief The state of each channel's filter.
+	analogFilterState_t	filterStates [ANALOG_CHANNEL_COUNT];
+
+	/// @brief The number of sweeps completed since @c rateTime , for measuring the sample rate.
+	uint32_t			rateSweepCount;
+
+	/// @brief The start of the current sample rate measurement.
+	systime_t			rateTime;
 } analog_t;
 
 // Functions ------------------------------------------------------------------------------------------------------------------
 
 /**
- * @brief Initializes the peripheral using the specified configuration.
+ * @brief Initializes the peripheral using the specified configuration. In continuous / triggered mode, the conversion is
+ * started.
  * @param analog The ADC to initialize.
  * @param config The configuration to use.
  * @return True if successful, false otherwise.
@@ -59,10 +417,60 @@ typedef struct
 bool analogInit (analog_t* analog, analogConfig_t* config);
 
 /**
- * @brief Samples all of the ADC's channels, blocking until the operation is complete.
+ * @brief Samples all of the ADC's channels, blocking until the operation is complete. Only applicable to single mode.
  * @param analog The ADC to sample from.
  * @return True is successful, false otherwise.
  */
 bool analogSample (analog_t* analog);
 
+/**
+ * @brief Gets the mean latency of the conversions of an ADC.
+ * @param analog The ADC to get the latency of.
+ * @return The mean latency, in CPU cycles, 0 if no conversions have completed.
+ */
+uint32_t analogGetMeanLatency (analog_t* analog);
+
+/**
+ * @brief Resets the statistics of an ADC.
+ * @param analog The ADC to reset.
+ */
+void analogResetStats (analog_t* analog);
+
+/**
+ * @brief Starts a conversion of the injected group, preempting the regular sweep. Does not block, the injected handlers are
+ * called from the ADC's interrupt once the conversion is complete. Only applicable if the injected group is triggered by
+ * software.
+ * @param analog The ADC to sample from.
+ * @return True if successful, false otherwise.
+ */
+bool analogSampleInjected (analog_t* analog);
+
+/**
+ * @brief Modifies the window of the analog watchdog at runtime (ex. after a sensor's calibration has changed its valid
+ * range). Takes effect immediately, including while the ADC is converting.
+ * @param analog The ADC whose watchdog to modify.
+ * @param low The lowest sample (inclusive) not tripping the watchdog.
+ * @param high The highest sample (inclusive) not tripping the watchdog. Values above the 12-bit range are clamped to it.
+ * @return True if successful, false if the watchdog is disabled or @c low is greater than @c high .
+ */
+bool analogSetWatchdogWindow (analog_t* analog, adcsample_t low, adcsample_t high);
+
+#if STM32_ADC_USE_ADC1
+/**
+ * @brief Handles ADC1's injected conversions, must be called from @c STM32_ADC_ADC1_IRQ_HOOK .
+ * @param sr The status register, as read by the driver's interrupt.
+ */
+void analogAdc1IrqHook (uint32_t sr);
+#endif // STM32_ADC_USE_ADC1
+
+#if STM32_ADC_USE_ADC2
+/// @brief ADC2 equivalent of @c analogAdc1IrqHook .
+void analogAdc2IrqHook (uint32_t sr);
+#endif // STM32_ADC_USE_ADC2
+
+#if STM32_ADC_USE_ADC3
+/// @brief ADC3 equivalent of @c analogAdc1IrqHook .
+void analogAdc3IrqHook (uint32_t sr);
+#endif // STM32_ADC_USE_ADC3
+
 #endif // ANALOG_H
\ No newline at end of file
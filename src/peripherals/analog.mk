@@ -1,2 +1,5 @@
+# Include the module's common dependencies
+include common/src/controls/transfer_function.mk
+
 # Add the module's source file to the compilation
 CSRC += common/src/peripherals/analog.c
\ No newline at end of file
@@ -0,0 +1,92 @@
+// Header
+#include "crc32.h"
+
+// ChibiOS
+#include "hal.h"
+
+// C Standard Library
+#include <string.h>
+
+// Constants ------------------------------------------------------------------------------------------------------------------
+
+/// @brief The generator polynomial of the CRC (same as that of the STM32 CRC unit).
+#define CRC32_POLYNOMIAL 0x04C11DB7
+
+/// @brief The initial value of the CRC (same as the reset value of the STM32 CRC unit).
+#define CRC32_INITIAL 0xFFFFFFFF
+
+// Global Data ----------------------------------------------------------------------------------------------------------------
+
+#ifdef CRC
+
+/// @brief Mutex guarding the CRC unit, which holds the CRC of the calculation in progress.
+static MUTEX_DECL (crc32Mutex);
+
+#endif // CRC
+
+// Function Prototypes --------------------------------------------------------------------------------------------------------
+
+uint32_t crc32Word (uint32_t crc, uint32_t word);
+
+// Functions ------------------------------------------------------------------------------------------------------------------
+
+#ifdef CRC
+
+uint32_t crc32Word (uint32_t crc, uint32_t word)
+{
+	// The hardware unit holds the CRC internally.
+	(void) crc;
+	CRC->DR = word;
+	return CRC->DR;
+}
+
+#else
+
+uint32_t crc32Word (uint32_t crc, uint32_t word)
+{
+	// Shift the word through the CRC, MSB first.
+	crc ^= word;
+	for (uint8_t bit = 0; bit < 32; ++bit)
+		crc = (crc & 0x80000000) ? (crc << 1) ^ CRC32_POLYNOMIAL : (crc << 1);
+
+	return crc;
+}
+
+#endif // CRC
+
+uint32_t crc32Calculate (const void* data, size_t dataCount)
+{
+	const uint8_t* bytes = (const uint8_t*) data;
+	uint32_t crc = CRC32_INITIAL;
+
+	#ifdef CRC
+	// Enable the CRC unit's clock (no effect if already enabled), lock it and reset it to the initial value. A mutex is used
+	// rather than a critical section, as the size of the data (and so the duration of the calculation) is unbounded.
+	rccEnableCRC (false);
+	chMtxLock (&crc32Mutex);
+	CRC->CR = CRC_CR_RESET;
+	#endif // CRC
+
+	// Process all of the full words. Note memcpy is used as the data is not guaranteed to be aligned.
+	size_t index = 0;
+	for (; index + 4 <= dataCount; index += 4)
+	{
+		uint32_t word;
+		memcpy (&word, bytes + index, 4);
+		crc = crc32Word (crc, word);
+	}
+
+	// Pad the remaining bytes (if any) with zeros.
+	if (index < dataCount)
+	{
+		uint32_t word = 0;
+		memcpy (&word, bytes + index, dataCount - index);
+		crc = crc32Word (crc, word);
+	}
+
+	#ifdef CRC
+	chMtxUnlock (&crc32Mutex);
+	#endif // CRC
+
+	return crc;
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+// CRC-32 Calculation ---------------------------------------------------------------------------------------------------------
+//
+// Author: agent
+// Date Created: 2026.10.17
+//
+// Description: Functions for calculating the CRC-32 of a block of memory. When built for the STM32F405 the hardware CRC
+//   calculation unit is used, otherwise (ex. host builds) a software implementation of the same algorithm is used.
+//
+//   The algorithm is that of the STM32 CRC unit: polynomial 0x04C11DB7, initial value 0xFFFFFFFF, no input / output
+//   reflection and no output XOR. Data is processed as 32-bit little-endian words, if the size of the data is not a multiple
+//   of 4 bytes, the final word is padded with zeros.
+
+// Includes -------------------------------------------------------------------------------------------------------------------
+
+// C Standard Library
+#include <stddef.h>
+#include <stdint.h>
+
+// Functions ------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Calculates the CRC-32 of a block of memory.
+ * @note When using the hardware CRC unit, the unit is locked by a mutex for the duration of the calculation, meaning this
+ * function may only be called from a thread context.
+ * @param data The block of memory to calculate the CRC of.
+ * @param dataCount The size of the block, in bytes.
+ * @return The calculated CRC.
+ */
+uint32_t crc32Calculate (const void* data, size_t dataCount);
+
+#endif // CRC32_H
\ No newline at end of file
@@ -0,0 +1,2 @@
+# Add the module's source file to the compilation
+CSRC += common/src/peripherals/crc32.c
\ No newline at end of file
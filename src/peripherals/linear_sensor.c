@@ -4,6 +4,26 @@
 // Includes
 #include "controls/lerp.h"
 
+// Function Prototypes --------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief In calibration mode, tracks the extremes of a sensor's samples.
+ */
+void linearSensorTrackCalibration (linearSensor_t* sensor, adcsample_t sample);
+
+/**
+ * @brief Computes the transfer function of a configuration, mapping the minimum sample to the minimum value and the maximum
+ * sample to the maximum value. The configuration must be valid.
+ */
+void linearSensorComputeTransfer (const linearSensorConfig_t* config, float* gain, float* offset);
+
+/**
+ * @brief Computes the valid sample range of a configuration, the sample bounds widened by the margin (saturating).
+ */
+void linearSensorComputeBounds (const linearSensorConfig_t* config, adcsample_t* validMin, adcsample_t* validMax);
+
+// Functions ------------------------------------------------------------------------------------------------------------------
+
 bool linearSensorInit (linearSensor_t* sensor, linearSensorConfig_t* config)
 {
 	// Store the configuration
@@ -18,8 +38,19 @@ bool linearSensorInit (linearSensor_t* sensor, linearSensorConfig_t* config)
 	// Set values to their defaults
 	sensor->value = 0.0f;
 	sensor->sample = 0;
+	sensor->calibrating = false;
+
+	// Copy the calibration. An invalid configuration never reaches the transfer function.
+	sensor->sampleMin = config->sampleMin;
+	sensor->sampleMax = config->sampleMax;
+	linearSensorComputeBounds (config, &sensor->validMin, &sensor->validMax);
+	sensor->gain = 0.0f;
+	sensor->offset = 0.0f;
+	if (sensor->state == LINEAR_SENSOR_CONFIG_INVALID)
+		return false;
 
-	return sensor->state != LINEAR_SENSOR_CONFIG_INVALID;
+	linearSensorComputeTransfer (config, &sensor->gain, &sensor->offset);
+	return true;
 }
 
 void linearSensorUpdate (void* object, adcsample_t sample)
@@ -28,13 +59,53 @@ void linearSensorUpdate (void* object, adcsample_t sample)
 
 	// Store the sample.
 	sensor->sample = sample;
+	linearSensorTrackCalibration (sensor, sample);
 
 	// If the config is invalid, don't check anything else.
 	if (sensor->state == LINEAR_SENSOR_CONFIG_INVALID)
 		return;
 
 	// Check the sample is in the valid range
-	if (sample < sensor->config->sampleMin || sample > sensor->config->sampleMax)
+	if (sample < sensor->validMin || sample > sensor->validMax)
+	{
+		sensor->state = LINEAR_SENSOR_VALUE_INVALID;
+		sensor->value = 0;
+		return;
+	}
+
+	sensor->state = LINEAR_SENSOR_VALID;
+
+	// Samples in the margin are clamped to the sample bounds.
+	if (sample < sensor->sampleMin)
+		sample = sensor->sampleMin;
+	else if (sample > sensor->sampleMax)
+		sample = sensor->sampleMax;
+
+	// Single multiply-add, contracted into a fused multiply-add by the compiler.
+	sensor->value = sensor->gain * sample + sensor->offset;
+}
+
+void linearSensorUpdateGeneric (void* object, adcsample_t sample)
+{
+	linearSensor_t* sensor = (linearSensor_t*) object;
+
+	// Store the sample.
+	sensor->sample = sample;
+	linearSensorTrackCalibration (sensor, sample);
+
+	// The configuration may have been modified since init, so is re-validated.
+	if (sensor->config->sampleMin >= sensor->config->sampleMax)
+	{
+		sensor->state = LINEAR_SENSOR_CONFIG_INVALID;
+		sensor->value = 0;
+		return;
+	}
+
+	// Check the sample is in the valid range
+	adcsample_t validMin;
+	adcsample_t validMax;
+	linearSensorComputeBounds (sensor->config, &validMin, &validMax);
+	if (sample < validMin || sample > validMax)
 	{
 		sensor->state = LINEAR_SENSOR_VALUE_INVALID;
 		sensor->value = 0;
@@ -43,7 +114,172 @@ void linearSensorUpdate (void* object, adcsample_t sample)
 
 	sensor->state = LINEAR_SENSOR_VALID;
 
+	// Samples in the margin are clamped to the sample bounds.
+	if (sample < sensor->config->sampleMin)
+		sample = sensor->config->sampleMin;
+	else if (sample > sensor->config->sampleMax)
+		sample = sensor->config->sampleMax;
+
 	// Map input min to output min, input max to output max.
 	sensor->value = lerp2d (sample, sensor->config->sampleMin, sensor->config->valueMin,
 		sensor->config->sampleMax, sensor->config->valueMax);
+}
+
+void linearSensorStartCalibration (linearSensor_t* sensor)
+{
+	// The sensor may be updated from an interrupt.
+	osalSysLock ();
+	sensor->calibrationMin = UINT16_MAX;
+	sensor->calibrationMax = 0;
+	sensor->calibrating = true;
+	osalSysUnlock ();
+}
+
+bool linearSensorFinishCalibration (linearSensor_t* sensor, adcsample_t margin)
+{
+	osalSysLock ();
+	sensor->calibrating = false;
+	adcsample_t sampleMin = sensor->calibrationMin;
+	adcsample_t sampleMax = sensor->calibrationMax;
+	osalSysUnlock ();
+
+	// The sensor must have been moved, otherwise the calibration would be invalid.
+	if (sampleMin >= sampleMax)
+		return false;
+
+	// Apply the calibration, re-computing the transfer function. The extremes themselves are mapped to the value bounds,
+	// the margin only widening the valid range.
+	osalSysLock ();
+	sensor->config->sampleMin = sampleMin;
+	sensor->config->sampleMax = sampleMax;
+	sensor->config->sampleMargin = margin;
+	linearSensorInit (sensor, sensor->config);
+	osalSysUnlock ();
+
+	return true;
+}
+
+void linearSensorTrackCalibration (linearSensor_t* sensor, adcsample_t sample)
+{
+	if (!sensor->calibrating)
+		return;
+
+	if (sample < sensor->calibrationMin)
+		sensor->calibrationMin = sample;
+
+	if (sample > sensor->calibrationMax)
+		sensor->calibrationMax = sample;
+}
+
+bool linearSensorArrayInit (linearSensorArray_t* array, linearSensorArrayConfig_t* config)
+{
+	// Store the configuration
+	array->config = config;
+	if (config->sensorCount > LINEAR_SENSOR_ARRAY_SIZE)
+	{
+		array->sensorCount = 0;
+		return false;
+	}
+
+	array->sensorCount = config->sensorCount;
+
+	bool result = true;
+	for (uint16_t index = 0; index < array->sensorCount; ++index)
+	{
+		linearSensorConfig_t* sensorConfig = config->configs [index];
+		array->indices [index]	= config->indices [index];
+		array->samples [index]	= 0;
+		array->values [index]	= 0.0f;
+
+		// Validate the configuration
+		if (sensorConfig->sampleMin >= sensorConfig->sampleMax)
+		{
+			array->states [index] = LINEAR_SENSOR_CONFIG_INVALID;
+			result = false;
+			continue;
+		}
+
+		array->states [index] = LINEAR_SENSOR_VALUE_INVALID;
+
+		array->sampleMins [index] = sensorConfig->sampleMin;
+		array->sampleMaxs [index] = sensorConfig->sampleMax;
+		linearSensorComputeBounds (sensorConfig, &array->validMins [index], &array->validMaxs [index]);
+		linearSensorComputeTransfer (sensorConfig, &array->gains [index], &array->offsets [index]);
+	}
+
+	return result;
+}
+
+void linearSensorArrayUpdate (void* object, const adcsample_t* samples, uint16_t count)
+{
+	linearSensorArray_t* array = (linearSensorArray_t*) object;
+
+	for (uint16_t index = 0; index < array->sensorCount; ++index)
+	{
+		// If the config is invalid, or the sample isn't in the buffer, don't check anything else.
+		if (array->states [index] == LINEAR_SENSOR_CONFIG_INVALID || array->indices [index] >= count)
+			continue;
+
+		adcsample_t sample = samples [array->indices [index]];
+		array->samples [index] = sample;
+
+		// Check the sample is in the valid range
+		bool valid = sample >= array->validMins [index] && sample <= array->validMaxs [index];
+
+		// Samples in the margin are clamped to the sample bounds.
+		if (sample < array->sampleMins [index])
+			sample = array->sampleMins [index];
+		else if (sample > array->sampleMaxs [index])
+			sample = array->sampleMaxs [index];
+
+		array->states [index] = valid ? LINEAR_SENSOR_VALID : LINEAR_SENSOR_VALUE_INVALID;
+		array->values [index] = valid ? array->gains [index] * sample + array->offsets [index] : 0.0f;
+	}
+}
+
+void linearSensorComputeTransfer (const linearSensorConfig_t* config, float* gain, float* offset)
+{
+	// Map input min to output min, input max to output max, value = gain * sample + offset.
+	*gain = (config->valueMax - config->valueMin) / (float) (config->sampleMax - config->sampleMin);
+	*offset = config->valueMin - *gain * config->sampleMin;
+}
+
+void linearSensorComputeBounds (const linearSensorConfig_t* config, adcsample_t* validMin, adcsample_t* validMax)
+{
+	adcsample_t margin = config->sampleMargin;
+	*validMin = config->sampleMin > margin ? config->sampleMin - margin : 0;
+	*validMax = config->sampleMax < UINT16_MAX - margin ? config->sampleMax + margin : UINT16_MAX;
+}
+
+void linearSensorConfigureWatchdog (linearSensor_t* sensor, analogConfig_t* config, uint16_t index)
+{
+	config->watchdogHandler	= linearSensorWatchdog;
+	config->watchdogObject	= sensor;
+	config->watchdogIndex	= index;
+	linearSensorComputeWatchdogWindow (sensor, config, index, &config->watchdogLow, &config->watchdogHigh);
+}
+
+void linearSensorComputeWatchdogWindow (linearSensor_t* sensor, const analogConfig_t* config, uint16_t index,
+	adcsample_t* low, adcsample_t* high)
+{
+	// The watchdog compares raw conversions, whereas the samples of an oversampled channel have log2 (k) / 2 (rounded down)
+	// extra bits of resolution. The window is widened to the raw conversions containing the valid range.
+	uint8_t extraBits = 0;
+	for (uint16_t factor = config->oversampling [index]; factor >= 4; factor >>= 2)
+		++extraBits;
+
+	*low = sensor->validMin >> extraBits;
+	*high = ((uint32_t) sensor->validMax + (1u << extraBits) - 1) >> extraBits;
+}
+
+void linearSensorWatchdog (void* object)
+{
+	linearSensor_t* sensor = (linearSensor_t*) object;
+
+	// If the config is invalid, the sensor is never valid anyways.
+	if (sensor->state == LINEAR_SENSOR_CONFIG_INVALID)
+		return;
+
+	sensor->state = LINEAR_SENSOR_VALUE_INVALID;
+	sensor->value = 0;
 }
\ No newline at end of file
@@ -8,10 +8,31 @@
 //
 // Description: Object representing a sensor with a linear transfer function. While this is mainly designed to be used with the
 //   analog_t object, this may be used to represent analog input of any form (ex. CAN).
+//
+//   The sensor's calibration (the valid sample range, and the gain and offset of the transfer function) is copied from its
+//   configuration at init, such that each update is a range check and a multiply-add. If the configuration is modified at
+//   runtime, the sensor must either be re-initialized, or be updated by linearSensorUpdateGeneric, which reads the
+//   configuration on each sample.
+//
+//   A sensor may be calibrated at runtime (ex. pedals, between drivers). While in calibration mode, the extremes of the
+//   sensor's samples are tracked, the sensor being moved through its full range by the operator. Finishing the calibration
+//   writes the extremes to the sensor's configuration as its sample bounds, such that they map to the value bounds exactly,
+//   and a margin around them as its sample margin, such that noise at the extremes of the sensor's travel is still valid
+//   (the value being clamped). See linear_sensor_calibration.h for persisting the calibration.
+//
+//   A group of sensors sampled by the same analog_t may instead be represented by a single linearSensorArray_t, updated in
+//   one pass over the sampled buffer by the analog_t's block handler. The calibrations are stored as a structure of arrays,
+//   with the gain and offset of each sensor precomputed, such that each sample is a range check and a multiply-add.
 
 // Includes -------------------------------------------------------------------------------------------------------------------
 
 #include "hal.h"
+#include "peripherals/analog.h"
+
+// Constants ------------------------------------------------------------------------------------------------------------------
+
+/// @brief The maximum number of sensors in a linear sensor array.
+#define LINEAR_SENSOR_ARRAY_SIZE ANALOG_CHANNEL_COUNT
 
 // Datatypes ------------------------------------------------------------------------------------------------------------------
 
@@ -29,6 +50,10 @@ typedef struct
 	/// @brief The output value mapped to the maximum sample value.
 	float valueMax;
 
+	/// @brief Samples up to this far outside of the sample bounds are still valid, their values being clamped to the value
+	/// bounds. Use 0 for no margin.
+	adcsample_t sampleMargin;
+
 } linearSensorConfig_t;
 
 typedef enum
@@ -49,8 +74,67 @@ typedef struct
 	linearSensorConfig_t*	config;
 	adcsample_t				sample;
 	float					value;
+
+	/// @brief The minimum sample, copied from the configuration. Samples in the margin below it are clamped to it.
+	adcsample_t				sampleMin;
+
+	/// @brief The maximum sample, copied from the configuration. Samples in the margin above it are clamped to it.
+	adcsample_t				sampleMax;
+
+	/// @brief The lowest valid sample, the minimum sample less the margin.
+	adcsample_t				validMin;
+
+	/// @brief The highest valid sample, the maximum sample plus the margin.
+	adcsample_t				validMax;
+
+	/// @brief The gain of the transfer function, value = gain * sample + offset.
+	float					gain;
+
+	/// @brief The offset of the transfer function.
+	float					offset;
+
+	/// @brief Indicates the sensor is in calibration mode.
+	bool					calibrating;
+
+	/// @brief In calibration mode, the lowest sample since the calibration started.
+	adcsample_t				calibrationMin;
+
+	/// @brief In calibration mode, the highest sample since the calibration started.
+	adcsample_t				calibrationMax;
 } linearSensor_t;
 
+typedef struct
+{
+	/// @brief The number of sensors in the array.
+	uint16_t sensorCount;
+
+	/// @brief The configuration of each sensor.
+	linearSensorConfig_t* configs [LINEAR_SENSOR_ARRAY_SIZE];
+
+	/// @brief The index of each sensor's sample in the updated buffer (ex. its channel's index in the analog_t's sequence).
+	uint16_t indices [LINEAR_SENSOR_ARRAY_SIZE];
+} linearSensorArrayConfig_t;
+
+/**
+ * @brief Group of linear sensors, updated together. The state, sample and value of sensor @c i are @c states [i] ,
+ * @c samples [i] and @c values [i] respectively.
+ */
+typedef struct
+{
+	linearSensorArrayConfig_t*	config;
+	uint16_t					sensorCount;
+	uint16_t					indices [LINEAR_SENSOR_ARRAY_SIZE];
+	adcsample_t					sampleMins [LINEAR_SENSOR_ARRAY_SIZE];
+	adcsample_t					sampleMaxs [LINEAR_SENSOR_ARRAY_SIZE];
+	adcsample_t					validMins [LINEAR_SENSOR_ARRAY_SIZE];
+	adcsample_t					validMaxs [LINEAR_SENSOR_ARRAY_SIZE];
+	float						gains [LINEAR_SENSOR_ARRAY_SIZE];
+	float						offsets [LINEAR_SENSOR_ARRAY_SIZE];
+	linearSensorState_t			states [LINEAR_SENSOR_ARRAY_SIZE];
+	adcsample_t					samples [LINEAR_SENSOR_ARRAY_SIZE];
+	float						values [LINEAR_SENSOR_ARRAY_SIZE];
+} linearSensorArray_t;
+
 // Functions ------------------------------------------------------------------------------------------------------------------
 
 /**
@@ -62,11 +146,94 @@ typedef struct
 bool linearSensorInit (linearSensor_t* sensor, linearSensorConfig_t* config);
 
 /**
- * @brief Updates the value of the sensor.
+ * @brief Updates the value of the sensor, using the calibration computed at init.
  * @note This function uses a @c void* for the object reference as to make the signature usable by callbacks.
  * @param object The sensor to update (must be a @c linearSensor_t* ).
  * @param sample The read sample.
  */
 void linearSensorUpdate (void* object, adcsample_t sample);
 
+/**
+ * @brief Updates the value of the sensor, reading the calibration from its configuration. Use for sensors whose
+ * configuration is modified at runtime, without re-initializing them.
+ * @note This function uses a @c void* for the object reference as to make the signature usable by callbacks.
+ * @param object The sensor to update (must be a @c linearSensor_t* ).
+ * @param sample The read sample.
+ */
+void linearSensorUpdateGeneric (void* object, adcsample_t sample);
+
+/**
+ * @brief Puts the sensor in calibration mode, tracking the extremes of its samples until the calibration is finished. The
+ * sensor is updated as normal in the meantime.
+ * @param sensor The sensor to calibrate.
+ */
+void linearSensorStartCalibration (linearSensor_t* sensor);
+
+/**
+ * @brief Finishes the calibration of the sensor, writing the tracked extremes to its configuration and re-initializing it.
+ * The tracked extremes are mapped to the value bounds.
+ * @note The window of the analog watchdog is not modified. If the sensor is guarded by it (see
+ * @c linearSensorConfigureWatchdog ), the caller must update the window to the sensor's new valid range, see
+ * @c linearSensorComputeWatchdogWindow .
+ * @param sensor The sensor to calibrate.
+ * @param margin The sample margin of the calibration, such that noise at the extremes of the sensor's travel is not
+ * considered out of range (the value being clamped).
+ * @return True if successful, false if the sensor was not moved through a range (the previous calibration is kept).
+ */
+bool linearSensorFinishCalibration (linearSensor_t* sensor, adcsample_t margin);
+
+/**
+ * @brief Initializes an array of sensors using the specified configuration. The calibration of each sensor is copied from
+ * its configuration, so this must be called again if a configuration is modified.
+ * @param array The array to initialize.
+ * @param config The configuration to use.
+ * @return True if every sensor's configuration is valid, false otherwise. Sensors with a valid configuration are still
+ * usable.
+ */
+bool linearSensorArrayInit (linearSensorArray_t* array, linearSensorArrayConfig_t* config);
+
+/**
+ * @brief Updates the values of an array of sensors.
+ * @note This function uses a @c void* for the object reference as to make the signature usable by callbacks (see
+ * @c analogConfig_t::blockHandler ).
+ * @param object The array to update (must be a @c linearSensorArray_t* ).
+ * @param samples The buffer of samples, indexed by each sensor's index.
+ * @param count The number of samples in the buffer.
+ */
+void linearSensorArrayUpdate (void* object, const adcsample_t* samples, uint16_t count);
+
+/**
+ * @brief Configures an analog_t's watchdog to guard a sensor's channel, using the sensor's valid sample range (including the
+ * margin) as the window. If the channel is oversampled, the window is scaled back to the raw conversions the watchdog
+ * compares (rounded outwards).
+ * When tripped, the sensor is invalidated immediately, rather than by its next update.
+ * @note Must be called after the sensor is initialized, and before the analog_t is.
+ * @param sensor The sensor to guard.
+ * @param config The configuration of the analog_t sampling the sensor.
+ * @param index The index of the sensor's channel in the analog_t's sequence.
+ */
+void linearSensorConfigureWatchdog (linearSensor_t* sensor, analogConfig_t* config, uint16_t index);
+
+/**
+ * @brief Computes the analog watchdog's window of a sensor, its valid sample range in raw (12-bit) conversions. Used to
+ * update the window after the sensor's calibration has changed, ex.
+ * @c linearSensorComputeWatchdogWindow (&sensor, &adcConfig, index, &low, &high);
+ * @c analogSetWatchdogWindow (&adc, low, high);
+ * @note The window may exceed the 12-bit range, in which case the analog_t clamps it.
+ * @param sensor The sensor to compute the window of.
+ * @param config The configuration of the analog_t sampling the sensor.
+ * @param index The index of the sensor's channel in the analog_t's sequence.
+ * @param low Written to contain the lowest conversion (inclusive) not tripping the watchdog.
+ * @param high Written to contain the highest conversion (inclusive) not tripping the watchdog.
+ */
+void linearSensorComputeWatchdogWindow (linearSensor_t* sensor, const analogConfig_t* config, uint16_t index,
+	adcsample_t* low, adcsample_t* high);
+
+/**
+ * @brief Watchdog handler of a sensor, invalidating it.
+ * @note This function uses a @c void* for the object reference as to make the signature usable by callbacks.
+ * @param object The sensor whose sample was out of range (must be a @c linearSensor_t* ).
+ */
+void linearSensorWatchdog (void* object);
+
 #endif // SENSOR_LINEAR_H
\ No newline at end of file
@@ -0,0 +1,69 @@
+// Header
+#include "linear_sensor_calibration.h"
+
+// C Standard Library
+#include <string.h>
+
+// Constants ------------------------------------------------------------------------------------------------------------------
+
+/// @brief Value identifying a valid calibration record. Distinct from an erased (0xFF) or zeroed memory.
+#define CALIBRATION_MAGIC 0xCA1B
+
+// Datatypes ------------------------------------------------------------------------------------------------------------------
+
+/// @brief The calibration record, as stored in the cache.
+typedef struct
+{
+	/// @brief @c CALIBRATION_MAGIC if the record has been written.
+	uint16_t magic;
+
+	/// @brief The minimum sample of the sensor.
+	uint16_t sampleMin;
+
+	/// @brief The maximum sample of the sensor.
+	uint16_t sampleMax;
+
+	/// @brief The sample margin of the sensor.
+	uint16_t sampleMargin;
+} calibrationRecord_t;
+
+typedef char calibrationRecordSizeCheck [sizeof (calibrationRecord_t) == LINEAR_SENSOR_CALIBRATION_SIZE ? 1 : -1];
+
+// Functions ------------------------------------------------------------------------------------------------------------------
+
+bool linearSensorSaveCalibration (linearSensor_t* sensor, mc24lc32_t* eeprom, uint16_t address)
+{
+	// The record must fit in a single page, such that only that page is modified.
+	if (address / MC24LC32_PAGE_SIZE != (address + LINEAR_SENSOR_CALIBRATION_SIZE - 1) / MC24LC32_PAGE_SIZE)
+		return false;
+
+	calibrationRecord_t record =
+	{
+		.magic			= CALIBRATION_MAGIC,
+		.sampleMin		= sensor->config->sampleMin,
+		.sampleMax		= sensor->config->sampleMax,
+		.sampleMargin	= sensor->config->sampleMargin
+	};
+
+	return mc24lc32WriteThrough (eeprom, address, (const uint8_t*) &record, sizeof (record));
+}
+
+bool linearSensorLoadCalibration (linearSensor_t* sensor, mc24lc32_t* eeprom, uint16_t address)
+{
+	// The cache must have been read successfully, and the record must be intact.
+	if (eeprom->state != MC24LC32_STATE_READY || address > MC24LC32_DATA_SIZE - LINEAR_SENSOR_CALIBRATION_SIZE ||
+		!mc24lc32IsRegionValid (eeprom, address, LINEAR_SENSOR_CALIBRATION_SIZE))
+		return false;
+
+	calibrationRecord_t record;
+	memcpy (&record, eeprom->cache + address, sizeof (record));
+
+	// Reject records that were never written, or that would invalidate the sensor.
+	if (record.magic != CALIBRATION_MAGIC || record.sampleMin >= record.sampleMax)
+		return false;
+
+	sensor->config->sampleMin = record.sampleMin;
+	sensor->config->sampleMax = record.sampleMax;
+	sensor->config->sampleMargin = record.sampleMargin;
+	return linearSensorInit (sensor, sensor->config);
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#ifndef LINEAR_SENSOR_CALIBRATION_H
+#define LINEAR_SENSOR_CALIBRATION_H
+
+// Linear Sensor Calibration --------------------------------------------------------------------------------------------------
+//
+// Author: agent
+// Date Created: 2026.10.17
+//
+// Description: Functions for persisting the runtime calibration of a linear sensor (see linearSensorStartCalibration) in the
+//   cache of a 24LC32 EEPROM. Each sensor's calibration is a small record at a reserved address of the cache, which must not
+//   cross a page boundary, such that saving a calibration modifies a single page.
+//
+//   At boot, the calibration is loaded straight from the cache (after the EEPROM has been read), overriding the sensor's
+//   default configuration. If the record is missing or corrupt, the default configuration is kept. For example:
+//
+//     mc24lc32Read (&eeprom);
+//     linearSensorInit (&apps1, &apps1Config);
+//     linearSensorLoadCalibration (&apps1, &eeprom, APPS_1_CALIBRATION_ADDRESS);
+//     ...
+//     analogInit (&adc, &adcConfig);
+//
+//   The calibration procedure is then:
+//
+//     linearSensorStartCalibration (&apps1);
+//     // Operator moves the pedal through its full travel.
+//     if (linearSensorFinishCalibration (&apps1, APPS_CALIBRATION_MARGIN))
+//     {
+//       linearSensorSaveCalibration (&apps1, &eeprom, APPS_1_CALIBRATION_ADDRESS);
+//
+//       // If the sensor is guarded by the analog watchdog, its window must follow the new calibration.
+//       adcsample_t low, high;
+//       linearSensorComputeWatchdogWindow (&apps1, &adcConfig, APPS_1_INDEX, &low, &high);
+//       analogSetWatchdogWindow (&adc, low, high);
+//     }
+
+// Includes -------------------------------------------------------------------------------------------------------------------
+
+// Includes
+#include "peripherals/linear_sensor.h"
+#include "peripherals/mc24lc32.h"
+
+// Constants ------------------------------------------------------------------------------------------------------------------
+
+/// @brief The size of a calibration record in the cache, in bytes.
+#define LINEAR_SENSOR_CALIBRATION_SIZE 8
+
+// Functions ------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Writes the sensor's calibration (its configuration's sample bounds and margin) to the EEPROM. The record is
+ * written to the cache and committed immediately.
+ * @note The commit writes any other pending modifications of the cache as well.
+ * @param sensor The sensor whose calibration to save.
+ * @param eeprom The EEPROM to write to.
+ * @param address The address of the record in the cache. The record must not cross a page boundary.
+ * @return True if successful, false otherwise.
+ */
+bool linearSensorSaveCalibration (linearSensor_t* sensor, mc24lc32_t* eeprom, uint16_t address);
+
+/**
+ * @brief Loads the sensor's calibration from the cache of the EEPROM, writing it to the sensor's configuration and
+ * re-initializing the sensor. Should be called at boot, after the EEPROM has been read.
+ * @param sensor The sensor whose calibration to load.
+ * @param eeprom The EEPROM to read from.
+ * @param address The address of the record in the cache.
+ * @return True if successful, false if the record is missing or corrupt (the sensor's configuration is not modified).
+ */
+bool linearSensorLoadCalibration (linearSensor_t* sensor, mc24lc32_t* eeprom, uint16_t address);
+
+#endif // LINEAR_SENSOR_CALIBRATION_H
\ No newline at end of file
@@ -0,0 +1,6 @@
+# Include the module's common dependencies
+include common/src/peripherals/linear_sensor.mk
+include common/src/peripherals/mc24lc32.mk
+
+# Add the module's source file to the compilation
+CSRC += common/src/peripherals/linear_sensor_calibration.c
\ No newline at end of file
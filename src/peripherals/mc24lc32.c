@@ -1,75 +1,170 @@
 // Header
 #include "mc24lc32.h"
 
+// Includes
+#include "peripherals/crc32.h"
+
 // ChibiOS
 #include "hal_i2c.h"
 
 // C Standard Library
+#include <stddef.h>
 #include <string.h>
 
 // Macros ---------------------------------------------------------------------------------------------------------------------
 
-/// @brief Maximum number of bytes to be written in a single operation.
-#define PAGE_SIZE 32
+/// @brief Maximum number of bytes to be read in a single bus transaction. Larger reads are split into multiple transactions,
+/// releasing the bus between each, such that other devices on the bus are not starved (64 bytes is ~1.5 ms at 400 kHz).
+#define READ_CHUNK_SIZE 64
 
-// Function Prototypes --------------------------------------------------------------------------------------------------------
+/// @brief Maximum duration of the device's internal write cycle (see datasheet Table 1-2, parameter 17 'TWC').
+#define WRITE_CYCLE_TIME TIME_MS2I (5)
+
+/// @brief Checks whether a page of the cache is marked as modified.
+#define PAGE_IS_DIRTY(mc24lc32, page) (((mc24lc32)->dirtyPages [(page) / 32] & (1u << ((page) % 32))) != 0)
+
+/// @brief Checks whether a page of the inactive bank is out of date.
+#define PAGE_IS_STALE(mc24lc32, page) (((mc24lc32)->stalePages [(page) / 32] & (1u << ((page) % 32))) != 0)
+
+/// @brief Gets the address of a bank's data.
+#define BANK_ADDRESS(bank) ((bank) * MC24LC32_BANK_SIZE)
+
+/// @brief Gets the address of a bank's commit record.
+#define RECORD_ADDRESS(bank) (BANK_ADDRESS (bank) + MC24LC32_DATA_SIZE)
 
-bool mc24lc32SequentialRead (mc24lc32_t* mc24lc32, uint16_t address, uint16_t count);
+// Datatypes ------------------------------------------------------------------------------------------------------------------
 
-bool mc24lc32PageWrite (mc24lc32_t* mc24lc32, uint16_t address, uint8_t count);
+/// @brief The commit record of a bank. Occupies exactly one page, such that it is written in a single operation.
+typedef struct
+{
+	/// @brief The generation of the bank's contents. The bank with the greater generation is the newer.
+	uint32_t generation;
+
+	/// @brief The CRC of each of the bank's regions.
+	uint32_t regionCrcs [MC24LC32_REGION_COUNT];
+
+	/// @brief The CRC of the above fields.
+	uint32_t crc;
+} mc24lc32Record_t;
+
+// Function Prototypes --------------------------------------------------------------------------------------------------------
+
+bool mc24lc32WaitForWriteCycle (mc24lc32_t* mc24lc32);
 
 bool mc24lc32AcknowledgePoll (mc24lc32_t* mc24lc32);
 
+bool mc24lc32Transmit (mc24lc32_t* mc24lc32, const uint8_t* tx, size_t txCount, uint8_t* rx, size_t rxCount);
+
+uint32_t mc24lc32RegionCrc (mc24lc32_t* mc24lc32, uint8_t region);
+
+bool mc24lc32RecordIsValid (mc24lc32Record_t* record);
+
+bool mc24lc32WriteRecord (mc24lc32_t* mc24lc32, uint8_t bank, uint32_t generation);
+
+void mc24lc32MigrateLegacy (mc24lc32_t* mc24lc32);
+
+void mc24lc32MarkStale (mc24lc32_t* mc24lc32, uint16_t address, uint16_t count);
+
+void mc24lc32MarkPages (uint32_t* pages, uint16_t address, uint16_t count);
+
+void mc24lc32CheckRegions (mc24lc32_t* mc24lc32, uint16_t address, uint16_t count);
+
 // Function Definitions -------------------------------------------------------------------------------------------------------
 
-/// @brief Read a sequential section of memory (see datasheet Section 8.3).
-bool mc24lc32SequentialRead (mc24lc32_t* mc24lc32, uint16_t address, uint16_t count)
+/// @brief Read a sequential section of memory (see datasheet Section 8.3). The read is split into chunks of at most
+/// @c READ_CHUNK_SIZE bytes, each of which is a separate bus transaction.
+bool mc24lc32SequentialRead (mc24lc32_t* mc24lc32, uint16_t address, uint8_t* data, uint16_t count)
 {
-	// Check the device is available for transfer
-	if (!mc24lc32AcknowledgePoll (mc24lc32))
+	// Wait for any pending write to complete
+	if (!mc24lc32WaitForWriteCycle (mc24lc32))
 		return false;
 
-	// Transactions starts with address (big-endian)
-	uint8_t tx [2] = { (uint8_t) (address) >> 8, (uint8_t) (address) };
+	bool result;
+	while (count > 0)
+	{
+		uint16_t chunkCount = count < READ_CHUNK_SIZE ? count : READ_CHUNK_SIZE;
 
-	// Receive into cache
-	uint8_t* rx = mc24lc32->cache + address;
+		// Transactions starts with address (big-endian)
+		uint8_t tx [2] = { (uint8_t) (address >> 8), (uint8_t) (address) };
 
-	msg_t result =  i2cMasterTransmit (mc24lc32->i2c, mc24lc32->addr, tx, 2, rx, count);
+		// Only hold the bus for the duration of this chunk
+		i2cAcquireBus (mc24lc32->i2c);
+		result = mc24lc32Transmit (mc24lc32, tx, 2, data, chunkCount);
+		i2cReleaseBus (mc24lc32->i2c);
 
-	if (result != MSG_OK)
-	{
-		mc24lc32->state = MC24LC32_STATE_FAILED;
-		return false;
+		if (!result)
+		{
+			mc24lc32->state = MC24LC32_STATE_FAILED;
+			return false;
+		}
+
+		address += chunkCount;
+		data += chunkCount;
+		count -= chunkCount;
+
+		// Let any waiting users of the bus run before the next chunk.
+		chThdYield ();
 	}
 
 	return true;
 }
 
-/// @brief Write into a page of memory (see datasheet Section 6.2).
-bool mc24lc32PageWrite (mc24lc32_t* mc24lc32, uint16_t address, uint8_t count)
+/// @brief Write into a page of memory (see datasheet Section 6.2). The device's write cycle is not waited for here, rather the
+/// next transfer waits for it, meaning the caller may do other work (or release the bus) in the meantime.
+bool mc24lc32PageWrite (mc24lc32_t* mc24lc32, uint16_t address, const uint8_t* data, uint8_t count)
 {
-	// Check the device is available for transfer
-	if (!mc24lc32AcknowledgePoll (mc24lc32))
+	// A write crossing a page boundary would wrap around to the beginning of the page, overwriting it.
+	if (count == 0 || address % MC24LC32_PAGE_SIZE + count > MC24LC32_PAGE_SIZE)
+		return false;
+
+	// Wait for the previous write to complete
+	if (!mc24lc32WaitForWriteCycle (mc24lc32))
 		return false;
 
 	// Transactions starts with address (big-endian)
-	uint8_t tx [PAGE_SIZE + 2] = { (uint8_t) ((address) >> 8), (uint8_t) (address) };
+	uint8_t tx [MC24LC32_PAGE_SIZE + 2] = { (uint8_t) ((address) >> 8), (uint8_t) (address) };
 
 	// Max of 32 bytes of data follow
-	memcpy (tx + 2, mc24lc32->cache + address, count);
+	memcpy (tx + 2, data, count);
 
-	msg_t result = i2cMasterTransmit (mc24lc32->i2c, mc24lc32->addr, tx, count + 2, NULL, 0);
+	// Acquire the bus. This is released after each page, so other devices may use the bus during the write cycle.
+	i2cAcquireBus (mc24lc32->i2c);
+	bool result = mc24lc32Transmit (mc24lc32, tx, count + 2, NULL, 0);
+	i2cReleaseBus (mc24lc32->i2c);
 
-	if (result != MSG_OK)
+	if (!result)
 	{
 		mc24lc32->state = MC24LC32_STATE_FAILED;
 		return false;
 	}
 
+	// The device is now busy with its write cycle
+	mc24lc32->writePending = true;
+	mc24lc32->writeTime = chVTGetSystemTime ();
+	return true;
+}
+
+/// @brief Waits for the device to complete the write cycle of the last page write, if any. The calling thread sleeps for
+/// the remainder of the nominal write cycle before polling the device, rather than continuously polling it.
+bool mc24lc32WaitForWriteCycle (mc24lc32_t* mc24lc32)
+{
+	// If no write is pending, the device is already available.
+	if (!mc24lc32->writePending)
+		return true;
+
+	sysinterval_t elapsed = chTimeDiffX (mc24lc32->writeTime, chVTGetSystemTime ());
+	if (elapsed < WRITE_CYCLE_TIME)
+		chThdSleep (WRITE_CYCLE_TIME - elapsed);
+
+	if (!mc24lc32AcknowledgePoll (mc24lc32))
+		return false;
+
+	mc24lc32->writePending = false;
 	return true;
 }
 
+/// @brief Polls the device until it acknowledges its address (see datasheet Section 7.0). The bus is only held for each
+/// individual poll.
 bool mc24lc32AcknowledgePoll (mc24lc32_t* mc24lc32)
 {
 	systime_t timeStart = chVTGetSystemTime ();
@@ -78,15 +173,106 @@ bool mc24lc32AcknowledgePoll (mc24lc32_t* mc24lc32)
 
 	while (chTimeDiffX (timeStart, chVTGetSystemTime ()) < mc24lc32->timeoutPeriod)
 	{
-		msg_t result = i2cMasterTransmit (mc24lc32->i2c, mc24lc32->addr, tx, 2, NULL, 0);
-		if (result == MSG_OK)
+		i2cAcquireBus (mc24lc32->i2c);
+		bool result = mc24lc32Transmit (mc24lc32, tx, 2, NULL, 0);
+		i2cReleaseBus (mc24lc32->i2c);
+
+		if (result)
 			return true;
+
+		// Let any waiting users of the bus run before the next poll.
+		chThdYield ();
 	}
 
 	mc24lc32->state = MC24LC32_STATE_FAILED;
 	return false;
 }
 
+/// @brief Performs a single bus transaction with the device. The transfer itself is performed by the I2C driver's DMA
+/// streams, the calling thread is suspended until it completes or the timeout period expires.
+bool mc24lc32Transmit (mc24lc32_t* mc24lc32, const uint8_t* tx, size_t txCount, uint8_t* rx, size_t rxCount)
+{
+	msg_t result = i2cMasterTransmitTimeout (mc24lc32->i2c, mc24lc32->addr, tx, txCount, rx, rxCount,
+		mc24lc32->timeoutPeriod);
+
+	// After a timeout the driver is left in an undefined state, so it must be restarted before it can be used again.
+	if (result == MSG_TIMEOUT)
+	{
+		const I2CConfig* config = mc24lc32->i2c->config;
+		i2cStop (mc24lc32->i2c);
+		i2cStart (mc24lc32->i2c, config);
+	}
+
+	return result == MSG_OK;
+}
+
+/// @brief Calculates the CRC of a region of the cache.
+uint32_t mc24lc32RegionCrc (mc24lc32_t* mc24lc32, uint8_t region)
+{
+	return crc32Calculate (mc24lc32->cache + region * MC24LC32_REGION_SIZE, MC24LC32_REGION_SIZE);
+}
+
+/// @brief Checks whether a commit record was completely written. Note an erased record (all 1's) is never valid.
+bool mc24lc32RecordIsValid (mc24lc32Record_t* record)
+{
+	return record->generation != 0xFFFFFFFF && record->crc == crc32Calculate (record, offsetof (mc24lc32Record_t, crc));
+}
+
+/// @brief Writes the commit record of a bank, using the current region CRCs.
+bool mc24lc32WriteRecord (mc24lc32_t* mc24lc32, uint8_t bank, uint32_t generation)
+{
+	mc24lc32Record_t record =
+	{
+		.generation = generation
+	};
+	memcpy (record.regionCrcs, mc24lc32->regionCrcs, sizeof (record.regionCrcs));
+	record.crc = crc32Calculate (&record, offsetof (mc24lc32Record_t, crc));
+
+	return mc24lc32PageWrite (mc24lc32, RECORD_ADDRESS (bank), (uint8_t*) &record, sizeof (record));
+}
+
+/// @brief Migrates a legacy image, if the device holds one. Must only be called after reading a device with no valid commit
+/// records, bank 0 being in the cache.
+void mc24lc32MigrateLegacy (mc24lc32_t* mc24lc32)
+{
+	// A legacy image starts with the magic string, same as the cache. Otherwise the memory is simply invalid.
+	uint8_t stringSize = strlen (mc24lc32->magicString) + 1;
+	if (strncmp ((const char*) mc24lc32->cache, mc24lc32->magicString, stringSize) != 0)
+		return;
+
+	// Check the legacy image has no data past the end of the cache, as this would be lost (overwritten by the commit record
+	// and bank 1). Unused memory is either erased or zeroed, depending on how the image was written.
+	for (uint16_t address = MC24LC32_DATA_SIZE; address < MC24LC32_SIZE; address += MC24LC32_PAGE_SIZE)
+	{
+		uint8_t page [MC24LC32_PAGE_SIZE];
+		if (!mc24lc32SequentialRead (mc24lc32, address, page, MC24LC32_PAGE_SIZE))
+			return;
+
+		for (uint8_t index = 0; index < MC24LC32_PAGE_SIZE; ++index)
+		{
+			if (page [index] != 0x00 && page [index] != 0xFF)
+			{
+				mc24lc32->state = MC24LC32_STATE_LEGACY;
+				return;
+			}
+		}
+	}
+
+	// The cache is the migrated image, so committing it to bank 0 only requires its commit record. If this is interrupted,
+	// the migration is re-attempted on the next read.
+	for (uint8_t region = 0; region < MC24LC32_REGION_COUNT; ++region)
+		mc24lc32->regionCrcs [region] = mc24lc32RegionCrc (mc24lc32, region);
+
+	if (!mc24lc32WriteRecord (mc24lc32, 0, 1))
+		return;
+
+	// Bank 1 remains entirely out of date (it was never committed).
+	mc24lc32->activeBank = 0;
+	mc24lc32->generation = 1;
+	mc24lc32->checkedRegions = (1 << MC24LC32_REGION_COUNT) - 1;
+	mc24lc32->validRegions = (1 << MC24LC32_REGION_COUNT) - 1;
+}
+
 bool mc24lc32Init (mc24lc32_t* mc24lc32, mc24lc32Config_t *config)
 {
 	// Store the driver configuration
@@ -95,8 +281,11 @@ bool mc24lc32Init (mc24lc32_t* mc24lc32, mc24lc32Config_t *config)
 	mc24lc32->magicString	= config->magicString;
 	mc24lc32->timeoutPeriod	= config->timeoutPeriod;
 
-	// Start the device in the ready state
+	// Start the device in the ready state. Poll the device before the first transfer, in case a write was interrupted by a
+	// reset.
 	mc24lc32->state = MC24LC32_STATE_READY;
+	mc24lc32->writePending = true;
+	mc24lc32->writeTime = chVTGetSystemTime ();
 
 	// Read the EEPROM contents into memory
 	return mc24lc32Read (mc24lc32);
@@ -104,56 +293,216 @@ bool mc24lc32Init (mc24lc32_t* mc24lc32, mc24lc32Config_t *config)
 
 bool mc24lc32Read (mc24lc32_t* mc24lc32)
 {
-	// Acquire the bus
-	i2cAcquireBus (mc24lc32->i2c);
+	// Read the commit records of both banks.
+	mc24lc32Record_t records [MC24LC32_BANK_COUNT];
+	bool recordsValid [MC24LC32_BANK_COUNT];
+	for (uint8_t bank = 0; bank < MC24LC32_BANK_COUNT; ++bank)
+	{
+		if (!mc24lc32SequentialRead (mc24lc32, RECORD_ADDRESS (bank), (uint8_t*) &records [bank], sizeof (mc24lc32Record_t)))
+			return false;
+
+		recordsValid [bank] = mc24lc32RecordIsValid (&records [bank]);
+	}
 
-	// Perform a sequential read starting at address 0
-	bool result = mc24lc32SequentialRead (mc24lc32, 0x00, MC24LC32_SIZE);
+	// Use the bank with the newest valid record. If neither is valid, the memory is invalid, bank 0 is read regardless.
+	mc24lc32->activeBank = 0;
+	if (recordsValid [1] && (!recordsValid [0] || records [1].generation > records [0].generation))
+		mc24lc32->activeBank = 1;
 
-	// Release the bus
-	i2cReleaseBus (mc24lc32->i2c);
+	uint8_t active = mc24lc32->activeBank;
+	uint8_t inactive = active ^ 1;
 
-	// If the transaction failed, exit early
-	if (!result)
+	if (recordsValid [active])
+	{
+		mc24lc32->generation = records [active].generation;
+		memcpy (mc24lc32->regionCrcs, records [active].regionCrcs, sizeof (mc24lc32->regionCrcs));
+	}
+	else
+	{
+		mc24lc32->generation = 0;
+		memset (mc24lc32->regionCrcs, 0, sizeof (mc24lc32->regionCrcs));
+	}
+
+	// Read the active bank into the cache. Note the bus is only held for each chunk of the read.
+	if (!mc24lc32SequentialRead (mc24lc32, BANK_ADDRESS (active), mc24lc32->cache, MC24LC32_DATA_SIZE))
 		return false;
 
+	// The cache now matches the device, but none of the regions have been checked yet.
+	memset (mc24lc32->dirtyPages, 0, sizeof (mc24lc32->dirtyPages));
+	mc24lc32->checkedRegions = 0;
+	mc24lc32->validRegions = 0;
+
+	// Determine which pages of the inactive bank are out of date. A valid record means the bank was not modified since it
+	// was committed, so any region with a matching CRC is identical to that of the active bank. Otherwise nothing about the
+	// bank's contents can be assumed.
+	memset (mc24lc32->stalePages, 0, sizeof (mc24lc32->stalePages));
+	for (uint8_t region = 0; region < MC24LC32_REGION_COUNT; ++region)
+	{
+		if (recordsValid [active] && recordsValid [inactive] &&
+			records [active].regionCrcs [region] == records [inactive].regionCrcs [region])
+			continue;
+
+		mc24lc32MarkStale (mc24lc32, region * MC24LC32_REGION_SIZE, MC24LC32_REGION_SIZE);
+	}
+
+	// If neither bank was ever committed, the memory may hold a legacy image.
+	if (!recordsValid [0] && !recordsValid [1])
+	{
+		mc24lc32MigrateLegacy (mc24lc32);
+		if (mc24lc32->state == MC24LC32_STATE_LEGACY || mc24lc32->state == MC24LC32_STATE_FAILED)
+			return false;
+	}
+
 	// Check the validity of the memory
 	return mc24lc32IsValid (mc24lc32);
 }
 
 bool mc24lc32Write (mc24lc32_t* mc24lc32)
 {
-	// Acquire the bus
-	i2cAcquireBus (mc24lc32->i2c);
+	// Mark the entire cache as modified, then commit it.
+	mc24lc32MarkDirty (mc24lc32, 0, MC24LC32_DATA_SIZE);
+	return mc24lc32Commit (mc24lc32);
+}
+
+bool mc24lc32Commit (mc24lc32_t* mc24lc32)
+{
+	// Don't overwrite a legacy image that could not be migrated.
+	if (mc24lc32->state == MC24LC32_STATE_LEGACY)
+		return false;
+
+	// Bitmask of the regions containing a modified page.
+	uint32_t dirtyRegions = 0;
+	for (uint16_t page = 0; page < MC24LC32_PAGE_COUNT; ++page)
+		if (PAGE_IS_DIRTY (mc24lc32, page))
+			dirtyRegions |= 1 << (page * MC24LC32_PAGE_SIZE / MC24LC32_REGION_SIZE);
+
+	// If nothing was modified, there is nothing to commit.
+	if (dirtyRegions == 0)
+		return true;
+
+	uint8_t target = mc24lc32->activeBank ^ 1;
+
+	// Erase the target's commit record before modifying it. This guarantees a bank with a valid record has not been
+	// modified since it was committed.
+	uint8_t erased [MC24LC32_PAGE_SIZE];
+	memset (erased, 0xFF, sizeof (erased));
+	if (!mc24lc32PageWrite (mc24lc32, RECORD_ADDRESS (target), erased, MC24LC32_PAGE_SIZE))
+		return false;
 
-	bool result = true;
-	for (uint16_t address = 0; address < MC24LC32_SIZE; address += PAGE_SIZE)
+	// Write the modified pages and the pages the target missed in the previous commit. If a transaction fails, exit early,
+	// all pages remain marked, so they will be re-attempted on the next commit.
+	for (uint16_t page = 0; page < MC24LC32_PAGE_COUNT; ++page)
 	{
-		// If the transaction failed, exit early
-		result = mc24lc32PageWrite (mc24lc32, address, PAGE_SIZE);
-		if (!result)
-			break;
+		if (!PAGE_IS_DIRTY (mc24lc32, page) && !PAGE_IS_STALE (mc24lc32, page))
+			continue;
+
+		uint16_t address = page * MC24LC32_PAGE_SIZE;
+		if (!mc24lc32PageWrite (mc24lc32, BANK_ADDRESS (target) + address, mc24lc32->cache + address, MC24LC32_PAGE_SIZE))
+			return false;
 	}
 
-	// Release the bus
-	i2cReleaseBus (mc24lc32->i2c);
-	return result;
+	// Re-calculate the CRCs of the modified regions only, the rest are identical to those of the active bank.
+	for (uint8_t region = 0; region < MC24LC32_REGION_COUNT; ++region)
+		if ((dirtyRegions & (1 << region)) != 0)
+			mc24lc32->regionCrcs [region] = mc24lc32RegionCrc (mc24lc32, region);
+
+	// Write the target's commit record. Once this is written, the target is the newest valid bank.
+	if (!mc24lc32WriteRecord (mc24lc32, target, mc24lc32->generation + 1))
+		return false;
+
+	// The target is now the active bank. The previously active bank is now out of date by the modified pages.
+	mc24lc32->activeBank = target;
+	mc24lc32->generation = mc24lc32->generation + 1;
+	mc24lc32->checkedRegions |= dirtyRegions;
+	mc24lc32->validRegions |= dirtyRegions;
+	memcpy (mc24lc32->stalePages, mc24lc32->dirtyPages, sizeof (mc24lc32->stalePages));
+	memset (mc24lc32->dirtyPages, 0, sizeof (mc24lc32->dirtyPages));
+	return true;
 }
 
-bool mc24lc32WriteThrough (mc24lc32_t* mc24lc32, uint16_t address, uint8_t* data, uint8_t dataCount)
+bool mc24lc32Revert (mc24lc32_t* mc24lc32, uint16_t address, uint16_t count)
 {
-	// Copy the data into cache
-	memcpy (mc24lc32->cache + address, data, dataCount);
+	// Ignore anything outside of the cache
+	if (count == 0 || address >= MC24LC32_DATA_SIZE)
+		return true;
+	if (count > MC24LC32_DATA_SIZE - address)
+		count = MC24LC32_DATA_SIZE - address;
+
+	// Re-read every page overlapping the section from the active bank.
+	uint16_t pageFirst = address / MC24LC32_PAGE_SIZE;
+	uint16_t pageLast = (address + count - 1) / MC24LC32_PAGE_SIZE;
+	uint16_t pageAddress = pageFirst * MC24LC32_PAGE_SIZE;
+	uint16_t pageCount = pageLast - pageFirst + 1;
+
+	if (!mc24lc32SequentialRead (mc24lc32, BANK_ADDRESS (mc24lc32->activeBank) + pageAddress, mc24lc32->cache + pageAddress,
+		pageCount * MC24LC32_PAGE_SIZE))
+		return false;
 
-	// Acquire the bus
-	i2cAcquireBus (mc24lc32->i2c);
+	// The pages now match the active bank.
+	for (uint16_t page = pageFirst; page <= pageLast; ++page)
+		mc24lc32->dirtyPages [page / 32] &= ~(1u << (page % 32));
 
-	// Write the cached data to the device.
-	bool result = mc24lc32PageWrite (mc24lc32, address, dataCount);
+	return true;
+}
 
-	// Release the bus
-	i2cReleaseBus (mc24lc32->i2c);
-	return result;
+void mc24lc32MarkDirty (mc24lc32_t* mc24lc32, uint16_t address, uint16_t count)
+{
+	mc24lc32MarkPages (mc24lc32->dirtyPages, address, count);
+}
+
+void mc24lc32MarkStale (mc24lc32_t* mc24lc32, uint16_t address, uint16_t count)
+{
+	mc24lc32MarkPages (mc24lc32->stalePages, address, count);
+}
+
+/// @brief Sets the bits of a page bitmask corresponding to a section of the cache.
+void mc24lc32MarkPages (uint32_t* pages, uint16_t address, uint16_t count)
+{
+	// Ignore anything outside of the cache
+	if (count == 0 || address >= MC24LC32_DATA_SIZE)
+		return;
+	if (count > MC24LC32_DATA_SIZE - address)
+		count = MC24LC32_DATA_SIZE - address;
+
+	for (uint16_t page = address / MC24LC32_PAGE_SIZE; page <= (address + count - 1) / MC24LC32_PAGE_SIZE; ++page)
+		pages [page / 32] |= 1u << (page % 32);
+}
+
+bool mc24lc32CacheRead (const mc24lc32_t* mc24lc32, uint16_t address, void* data, uint16_t count)
+{
+	// Reject anything outside of the cache
+	if (address > MC24LC32_DATA_SIZE || count > MC24LC32_DATA_SIZE - address)
+		return false;
+
+	memcpy (data, mc24lc32->cache + address, count);
+	return true;
+}
+
+bool mc24lc32CacheWrite (mc24lc32_t* mc24lc32, uint16_t address, const void* data, uint16_t count)
+{
+	// Reject anything outside of the cache
+	if (address > MC24LC32_DATA_SIZE || count > MC24LC32_DATA_SIZE - address)
+		return false;
+
+	mc24lc32CheckRegions (mc24lc32, address, count);
+	memcpy (mc24lc32->cache + address, data, count);
+	mc24lc32MarkDirty (mc24lc32, address, count);
+	return true;
+}
+
+bool mc24lc32WriteThrough (mc24lc32_t* mc24lc32, uint16_t address, const uint8_t* data, uint16_t dataCount)
+{
+	// Reject anything outside of the cache
+	if (address > MC24LC32_DATA_SIZE || dataCount > MC24LC32_DATA_SIZE - address)
+		return false;
+
+	// Copy the data into cache
+	mc24lc32CheckRegions (mc24lc32, address, dataCount);
+	memcpy (mc24lc32->cache + address, data, dataCount);
+
+	// Commit the modified pages to the device. The commit writes each page the data overlaps exactly once.
+	mc24lc32MarkDirty (mc24lc32, address, dataCount);
+	return mc24lc32Commit (mc24lc32);
 }
 
 bool mc24lc32IsValid (mc24lc32_t* mc24lc32)
@@ -162,7 +511,8 @@ bool mc24lc32IsValid (mc24lc32_t* mc24lc32)
 	uint8_t stringSize = strlen (mc24lc32->magicString) + 1;
 	int result = strncmp ((const char*) mc24lc32->cache, mc24lc32->magicString, stringSize);
 
-	if (result != 0)
+	// Check the region containing the magic string is intact
+	if (result != 0 || !mc24lc32IsRegionValid (mc24lc32, 0, stringSize))
 	{
 		mc24lc32->state = MC24LC32_STATE_INVALID;
 		return false;
@@ -171,17 +521,67 @@ bool mc24lc32IsValid (mc24lc32_t* mc24lc32)
 	return true;
 }
 
+bool mc24lc32IsRegionValid (mc24lc32_t* mc24lc32, uint16_t address, uint16_t count)
+{
+	// Reject anything outside of the cache
+	if (address > MC24LC32_DATA_SIZE || count > MC24LC32_DATA_SIZE - address)
+		return false;
+
+	if (count == 0)
+		return true;
+
+	mc24lc32CheckRegions (mc24lc32, address, count);
+
+	// Note a region that was invalid but has since been committed is valid again.
+	for (uint8_t region = address / MC24LC32_REGION_SIZE; region <= (address + count - 1) / MC24LC32_REGION_SIZE; ++region)
+		if ((mc24lc32->validRegions & (1 << region)) == 0)
+			return false;
+
+	return true;
+}
+
+/// @brief Checks each region overlapping a section of the cache against its CRC, if it hasn't been already. Called before
+/// the section is modified, as the CRC is of the unmodified contents.
+void mc24lc32CheckRegions (mc24lc32_t* mc24lc32, uint16_t address, uint16_t count)
+{
+	// Ignore anything outside of the cache
+	if (count == 0 || address >= MC24LC32_DATA_SIZE)
+		return;
+	if (count > MC24LC32_DATA_SIZE - address)
+		count = MC24LC32_DATA_SIZE - address;
+
+	for (uint8_t region = address / MC24LC32_REGION_SIZE; region <= (address + count - 1) / MC24LC32_REGION_SIZE; ++region)
+	{
+		uint32_t mask = 1 << region;
+		if ((mc24lc32->checkedRegions & mask) != 0)
+			continue;
+
+		if (mc24lc32RegionCrc (mc24lc32, region) == mc24lc32->regionCrcs [region])
+			mc24lc32->validRegions |= mask;
+
+		mc24lc32->checkedRegions |= mask;
+	}
+}
+
 void mc24lc32Validate (mc24lc32_t* mc24lc32)
 {
 	// Copy the magic string into the beginning of memory (including terminator)
 	uint8_t stringSize = strlen (mc24lc32->magicString) + 1;
+	mc24lc32CheckRegions (mc24lc32, 0, stringSize);
 	memcpy (mc24lc32->cache, mc24lc32->magicString, stringSize);
+	mc24lc32MarkDirty (mc24lc32, 0, stringSize);
+
+	// The cache is no longer the legacy image, so it may be committed, discarding the image.
+	if (mc24lc32->state == MC24LC32_STATE_LEGACY)
+		mc24lc32->state = MC24LC32_STATE_INVALID;
 }
 
 void mc34lc32Invalidate (mc24lc32_t* mc24lc32)
 {
 	// Write all 1's over the magic string
 	uint8_t stringSize = strlen (mc24lc32->magicString) + 1;
+	mc24lc32CheckRegions (mc24lc32, 0, stringSize);
 	for (uint8_t index = 0; index < stringSize; ++index)
 		mc24lc32->cache [index] = 0xFF;
+	mc24lc32MarkDirty (mc24lc32, 0, stringSize);
 }
\ No newline at end of file
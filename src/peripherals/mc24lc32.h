@@ -6,7 +6,26 @@
 // Author: Cole Barach
 // Date Created: 2024.09.29
 //
-// Description: Driver for the Microchip 24LC32 I2C EEPROM.
+// Description: Driver for the Microchip 24LC32 I2C EEPROM. Transfers are split into bounded bus transactions (a chunk of a
+//   sequential read or a single page write), the bus is released between each such that other devices sharing the bus are
+//   not starved by large operations.
+//
+//   The device's memory holds two banks, each a full copy of the cache followed by a commit record. The commit record stores
+//   the bank's generation counter and the CRC of each of its integrity-checked regions, and is protected by its own CRC.
+//   Commits are written to the inactive bank, the commit record being written last, after which that bank becomes the
+//   active one. On boot the bank with the newest valid commit record is used, meaning a commit interrupted by a reset (or
+//   power loss) is rolled back, rather than leaving the memory half old and half new.
+//
+//   Modifications to the cache are tracked per page. A commit only writes the modified pages, plus the pages the inactive
+//   bank missed in the previous commit, and only re-calculates the CRCs of the regions they belong to. Region CRCs are not
+//   checked when the memory is read, rather each region is checked the first time its validity is requested.
+//
+//   Devices programmed with the legacy layout (a single image of the entire memory, without commit records) are migrated on
+//   the first read. As bank 0 occupies the beginning of the memory, the first MC24LC32_DATA_SIZE bytes of the legacy image
+//   are already in place, so the migration only writes bank 0's commit record. If the legacy image has data past the end of
+//   the cache (anything other than 0x00 / 0xFF), it cannot be migrated without losing that data, so the device is put in the
+//   legacy state instead, in which commits are rejected. Note the cache is smaller than the legacy image, offsets into the
+//   cache should be checked using MC24LC32_CACHE_ADDRESS, or accessed using mc24lc32CacheRead / mc24lc32CacheWrite.
 
 // Includes -------------------------------------------------------------------------------------------------------------------
 
@@ -18,12 +37,56 @@
 /// @brief Memory size of the MC24LC32 EEPROM in bytes.
 #define MC24LC32_SIZE 4096
 
+/// @brief Size of a page of the EEPROM in bytes. This is the maximum number of bytes that can be written in one operation.
+#define MC24LC32_PAGE_SIZE 32
+
+/// @brief Size of an integrity-checked region in bytes.
+#define MC24LC32_REGION_SIZE 256
+
+/// @brief Number of integrity-checked regions in the user-accessible memory. Limited by the size of a commit record.
+#define MC24LC32_REGION_COUNT 6
+
+/// @brief Size of the user-accessible memory (the cache) in bytes.
+#define MC24LC32_DATA_SIZE (MC24LC32_REGION_COUNT * MC24LC32_REGION_SIZE)
+
+/// @brief Number of pages in the user-accessible memory.
+#define MC24LC32_PAGE_COUNT (MC24LC32_DATA_SIZE / MC24LC32_PAGE_SIZE)
+
+/// @brief Size of a bank in bytes. Each bank is a full copy of the cache followed by a single page commit record.
+#define MC24LC32_BANK_SIZE (MC24LC32_DATA_SIZE + MC24LC32_PAGE_SIZE)
+
+/// @brief Number of banks in the device's memory. Banks occupy the beginning of the memory.
+#define MC24LC32_BANK_COUNT 2
+
+/// @brief Address of the journal area, the memory following the banks. This is not part of the cache, see
+/// @c mc24lc32_journal.h for its usage.
+#define MC24LC32_JOURNAL_ADDRESS (MC24LC32_BANK_COUNT * MC24LC32_BANK_SIZE)
+
+/// @brief Size of the journal area in bytes.
+#define MC24LC32_JOURNAL_SIZE (MC24LC32_SIZE - MC24LC32_JOURNAL_ADDRESS)
+
+// Macros ---------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Checks, at compile-time, that a section of the cache at a constant address is within the cache. Evaluates to the
+ * address, ex. @c mc24lc32->cache @c [MC24LC32_CACHE_ADDRESS @c (0x0100, @c 4)] .
+ * @param address The address of the section, must be a constant expression.
+ * @param count The size of the section in bytes, must be a constant expression.
+ */
+#define MC24LC32_CACHE_ADDRESS(address, count)																		\
+	((address) + 0 * sizeof (char [(address) + (count) <= MC24LC32_DATA_SIZE ? 1 : -1]))
+
 // Datatypes ------------------------------------------------------------------------------------------------------------------
 
 typedef enum
 {
 	MC24LC32_STATE_FAILED	= 0,
 	MC24LC32_STATE_INVALID	= 1,
+
+	/// @brief Indicates the device holds a legacy image that could not be migrated. Commits are rejected, such that the image
+	/// is not overwritten, until the cache is re-initialized by @c mc24lc32Validate .
+	MC24LC32_STATE_LEGACY	= 2,
+
 	MC24LC32_STATE_READY	= 3
 } mc24lc32State_t;
 
@@ -36,14 +99,18 @@ typedef struct
 	I2CDriver* i2c;
 
 	/// @brief The timeout interval for the device's acknowledgement polling. If the device does not send an acknowledgement
-	/// within this timeframe, it will be considered invalid.
+	/// within this timeframe, it will be considered invalid. This is also used as the timeout of each individual transfer.
 	sysinterval_t timeoutPeriod;
 
 	/// @brief The magic string used to validate the EEPROM's contents.
 	const char* magicString;
 } mc24lc32Config_t;
 
-/// @brief Driver for the Microchip 24LC32 I2C EEPROM.
+/**
+ * @brief Driver for the Microchip 24LC32 I2C EEPROM.
+ * @note Transfers are performed by the I2C driver's DMA streams directly to / from the cache, so this object must be placed
+ * in DMA-accessible memory (not the core-coupled memory).
+ */
 typedef struct
 {
 	/// @brief State of the device.
@@ -58,12 +125,42 @@ typedef struct
 	/// @brief The magic string used to validate the EEPROM's contents.
 	const char* magicString;
 
-	/// @brief Cached copy of the EEPROM's contents. Use for read / write operations.
-	uint8_t cache [MC24LC32_SIZE];
+	/// @brief Cached copy of the EEPROM's contents. Use for read / write operations. @note Modifications must be marked using
+	/// @c mc24lc32MarkDirty in order to be committed by @c mc24lc32Commit . Region CRCs are checked lazily, against the
+	/// cache's contents, so a region modified directly before being checked is reported invalid until it is committed. Use
+	/// @c mc24lc32CacheWrite (or call @c mc24lc32IsRegionValid before modifying the region) to avoid this.
+	uint8_t cache [MC24LC32_DATA_SIZE];
+
+	/// @brief The index of the bank the cache was read from / last committed to.
+	uint8_t activeBank;
+
+	/// @brief The generation counter of the active bank. Incremented with each commit.
+	uint32_t generation;
+
+	/// @brief The CRC of each region, as of the last read / commit. This is the contents of the active bank's commit record.
+	uint32_t regionCrcs [MC24LC32_REGION_COUNT];
+
+	/// @brief Bitmask of the regions that have been checked against their CRC since the last read.
+	uint32_t checkedRegions;
+
+	/// @brief Bitmask of the checked regions that matched their CRC.
+	uint32_t validRegions;
+
+	/// @brief Bitmask of the pages of the cache that have been modified since the last commit.
+	uint32_t dirtyPages [(MC24LC32_PAGE_COUNT + 31) / 32];
+
+	/// @brief Bitmask of the pages of the inactive bank that differ from the active bank.
+	uint32_t stalePages [(MC24LC32_PAGE_COUNT + 31) / 32];
 
 	/// @brief The timeout interval for the device's acknowledgement polling. If the device does not send an acknowledgement
 	/// within this timeframe, it will be considered invalid.
 	sysinterval_t timeoutPeriod;
+
+	/// @brief Indicates the device may still be busy with the write cycle of the last page write.
+	bool writePending;
+
+	/// @brief The time the last page write was issued at.
+	systime_t writeTime;
 } mc24lc32_t;
 
 // Functions ------------------------------------------------------------------------------------------------------------------
@@ -77,39 +174,127 @@ typedef struct
 bool mc24lc32Init (mc24lc32_t* mc24lc32, mc24lc32Config_t* config);
 
 /**
- * @brief Reads the contents of the devices memory into local cache.
+ * @brief Reads the contents of the devices memory into local cache. The commit records of both banks are read, the bank
+ * with the newest valid record is then read into the cache. The read is performed in chunks, the bus is released between
+ * each chunk. If neither bank has a valid record, a legacy image is migrated (see the description above).
  * @param mc24lc32 The device to read from.
  * @return True if successful and the memory is valid, false otherwise.
  */
 bool mc24lc32Read (mc24lc32_t* mc24lc32);
 
 /**
- * @brief Writes the local cached memory to the device.
+ * @brief Writes the entirety of the local cached memory to the device, regardless of what has been modified. The write is
+ * performed one page at a time, the bus is released between each page.
+ * @note As the other bank then differs in every page, the following commit will also write every page.
  * @param mc24lc32 The device to write to.
  * @return True if successful, false otherwise.
  */
 bool mc24lc32Write (mc24lc32_t* mc24lc32);
 
 /**
- * @brief Writes the specified data to the device.
+ * @brief Writes the modified pages of the local cached memory to the inactive bank, along with the pages it missed in the
+ * previous commit, then writes its commit record, making it the active bank. If the commit is interrupted, the previously
+ * active bank remains the newest valid one.
+ * @param mc24lc32 The device to write to.
+ * @return True if successful, false otherwise. Commits are rejected in the legacy state.
+ */
+bool mc24lc32Commit (mc24lc32_t* mc24lc32);
+
+/**
+ * @brief Marks a section of the local cached memory as modified, such that it is written by the next commit.
+ * @param mc24lc32 The device whose cache was modified.
+ * @param address The address of the modified section.
+ * @param count The size of the modified section, in bytes.
+ */
+void mc24lc32MarkDirty (mc24lc32_t* mc24lc32, uint16_t address, uint16_t count);
+
+/**
+ * @brief Discards the modifications to a section of the local cached memory, re-reading it from the device.
+ * @note This is performed per page, meaning any modification to a page overlapping the section is discarded as well.
+ * @param mc24lc32 The device to revert.
+ * @param address The address of the section to revert.
+ * @param count The size of the section, in bytes.
+ * @return True if successful, false otherwise.
+ */
+bool mc24lc32Revert (mc24lc32_t* mc24lc32, uint16_t address, uint16_t count);
+
+/**
+ * @brief Copies a section of the cache.
+ * @param mc24lc32 The device to read the cache of.
+ * @param address The address of the section.
+ * @param data The buffer to copy the section into.
+ * @param count The size of the section, in bytes.
+ * @return True if successful, false if the section extends past the end of the cache.
+ */
+bool mc24lc32CacheRead (const mc24lc32_t* mc24lc32, uint16_t address, void* data, uint16_t count);
+
+/**
+ * @brief Modifies a section of the cache, marking it as modified. The regions overlapping the section are checked against
+ * their CRCs before being modified (see @c mc24lc32IsRegionValid ).
+ * @param mc24lc32 The device to modify the cache of.
+ * @param address The address of the section.
+ * @param data The data to write to the section.
+ * @param count The size of the section, in bytes.
+ * @return True if successful, false if the section extends past the end of the cache.
+ */
+bool mc24lc32CacheWrite (mc24lc32_t* mc24lc32, uint16_t address, const void* data, uint16_t count);
+
+/**
+ * @brief Writes the specified data to the device. Any other modifications to the cache that are pending are committed as
+ * well. The data may span any number of pages, each page it overlaps is written once.
  * @param mc24lc32 The device to write to.
  * @param address The address to write to.
  * @param data The array of data to write.
  * @param dataCount The size of the data array.
+ * @return True if successful, false otherwise. Writes extending past the end of the cache are rejected.
+ */
+bool mc24lc32WriteThrough (mc24lc32_t* mc24lc32, uint16_t address, const uint8_t* data, uint16_t dataCount);
+
+/**
+ * @brief Reads a sequential section of the device's memory, bypassing the cache. The read is performed in chunks, the bus is
+ * released between each chunk.
+ * @param mc24lc32 The device to read from.
+ * @param address The physical address to read from.
+ * @param data The buffer to read into.
+ * @param count The number of bytes to read.
  * @return True if successful, false otherwise.
- * @note The write operation cannot cross a page boundary (32 byte).
  */
-bool mc24lc32WriteThrough (mc24lc32_t* mc24lc32, uint16_t address, uint8_t* data, uint8_t dataCount);
+bool mc24lc32SequentialRead (mc24lc32_t* mc24lc32, uint16_t address, uint8_t* data, uint16_t count);
 
 /**
- * @brief Checks whether the cached memory of the device is valid.
+ * @brief Writes into a page of the device's memory, bypassing the cache. The device's write cycle is completed by the next
+ * transfer, not by this call.
+ * @param mc24lc32 The device to write to.
+ * @param address The physical address to write to.
+ * @param data The data to write.
+ * @param count The number of bytes to write.
+ * @return True if successful, false otherwise.
+ * @note The write operation cannot cross a page boundary (32 byte), such writes are rejected.
+ */
+bool mc24lc32PageWrite (mc24lc32_t* mc24lc32, uint16_t address, const uint8_t* data, uint8_t count);
+
+/**
+ * @brief Checks whether the cached memory of the device is valid. This checks the magic string and the CRC of the region
+ * containing it.
  * @param mc24lc32 The device to check.
  * @return True if the cached memory is valid, false otherwise.
  */
 bool mc24lc32IsValid (mc24lc32_t* mc24lc32);
 
 /**
- * @brief Validates the cached memory of the device. Changes will be committed on the next write.
+ * @brief Checks whether a section of the cached memory matches the CRCs read from the device. Each region is only checked
+ * the first time it is requested, the result is remembered until the next read.
+ * @param mc24lc32 The device to check.
+ * @param address The address of the section to check.
+ * @param count The size of the section, in bytes.
+ * @return True if every region overlapping the section is valid, false otherwise. Sections extending past the end of the
+ * cache are rejected.
+ */
+bool mc24lc32IsRegionValid (mc24lc32_t* mc24lc32, uint16_t address, uint16_t count);
+
+/**
+ * @brief Validates the cached memory of the device. Changes will be committed on the next write. If the device holds a
+ * legacy image that could not be migrated, the image is discarded.
  * @param mc24lc32 The device to validate.
  */
 void mc24lc32Validate (mc24lc32_t* mc24lc32);
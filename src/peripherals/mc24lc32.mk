@@ -1,2 +1,5 @@
+# Include the module's common dependencies
+include common/src/peripherals/crc32.mk
+
 # Add the module's source file to the compilation
 CSRC += common/src/peripherals/mc24lc32.c
\ No newline at end of file
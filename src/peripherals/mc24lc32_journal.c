@@ -0,0 +1,219 @@
+// Header
+#include "mc24lc32_journal.h"
+
+// Includes
+#include "peripherals/crc32.h"
+
+// C Standard Library
+#include <string.h>
+
+// Constants ------------------------------------------------------------------------------------------------------------------
+
+/// @brief Size of an entry in bytes.
+#define ENTRY_SIZE 8
+
+/// @brief Number of entries in a page.
+#define PAGE_ENTRY_COUNT (MC24LC32_PAGE_SIZE / ENTRY_SIZE)
+
+/// @brief Number of entry slots in the journal area. Must be less than 128, such that sequence numbers are unambiguous.
+#define SLOT_COUNT (MC24LC32_JOURNAL_SIZE / ENTRY_SIZE)
+
+/// @brief Number of slots ahead of the head that are kept free of live entries. This must be greater than the number of
+/// entries a single write can append, such that a write never overwrites the only copy of a live entry.
+#define GAP_SLOT_COUNT (((MC24LC32_JOURNAL_KEY_COUNT + PAGE_ENTRY_COUNT) / PAGE_ENTRY_COUNT) * PAGE_ENTRY_COUNT)
+
+/// @brief Indicates a key has no entry.
+#define SLOT_NONE 0xFF
+
+// Datatypes ------------------------------------------------------------------------------------------------------------------
+
+/// @brief An entry of the journal. Each is an update of a single key.
+typedef struct
+{
+	/// @brief The key that was updated.
+	uint8_t key;
+
+	/// @brief The sequence number of the entry. Incremented for each entry, wrapping around.
+	uint8_t sequence;
+
+	/// @brief The lower 16 bits of the entry's CRC, calculated with this field set to 0.
+	uint16_t check;
+
+	/// @brief The value of the key.
+	uint32_t value;
+} mc24lc32JournalEntry_t;
+
+// Function Prototypes --------------------------------------------------------------------------------------------------------
+
+uint16_t mc24lc32JournalCheck (mc24lc32JournalEntry_t* entry);
+
+// Functions ------------------------------------------------------------------------------------------------------------------
+
+/// @brief Calculates the check field of an entry.
+uint16_t mc24lc32JournalCheck (mc24lc32JournalEntry_t* entry)
+{
+	mc24lc32JournalEntry_t copy = *entry;
+	copy.check = 0;
+	return (uint16_t) crc32Calculate (&copy, sizeof (copy));
+}
+
+bool mc24lc32JournalInit (mc24lc32Journal_t* journal, mc24lc32JournalConfig_t* config)
+{
+	if (config->keyCount > MC24LC32_JOURNAL_KEY_COUNT)
+		return false;
+
+	// Store the configuration
+	journal->eeprom		= config->eeprom;
+	journal->keyCount	= config->keyCount;
+
+	// Start with every key at its default value
+	for (uint8_t key = 0; key < journal->keyCount; ++key)
+	{
+		journal->values [key] = config->defaults != NULL ? config->defaults [key] : 0;
+		journal->slots [key] = SLOT_NONE;
+	}
+
+	journal->head = 0;
+	journal->sequence = 0;
+
+	// Scan the journal area for the newest entry, and the newest entry of each key. As all valid entries were written within
+	// the last SLOT_COUNT entries, the difference of any 2 sequence numbers is less than 128, so the newer of the 2 is the
+	// one with a positive signed difference.
+	bool entryFound = false;
+	uint8_t newestSequence = 0;
+	uint8_t newestSlot = 0;
+	uint8_t keySequences [MC24LC32_JOURNAL_KEY_COUNT];
+
+	for (uint8_t page = 0; page < SLOT_COUNT / PAGE_ENTRY_COUNT; ++page)
+	{
+		uint8_t buffer [MC24LC32_PAGE_SIZE];
+		if (!mc24lc32SequentialRead (journal->eeprom, MC24LC32_JOURNAL_ADDRESS + page * MC24LC32_PAGE_SIZE, buffer,
+			MC24LC32_PAGE_SIZE))
+			return false;
+
+		for (uint8_t index = 0; index < PAGE_ENTRY_COUNT; ++index)
+		{
+			mc24lc32JournalEntry_t entry;
+			memcpy (&entry, buffer + index * ENTRY_SIZE, ENTRY_SIZE);
+
+			// Ignore any entry that was never written, or was only partially written.
+			if (entry.key >= journal->keyCount || entry.check != mc24lc32JournalCheck (&entry))
+				continue;
+
+			uint8_t slot = page * PAGE_ENTRY_COUNT + index;
+
+			if (!entryFound || (int8_t) (entry.sequence - newestSequence) > 0)
+			{
+				entryFound = true;
+				newestSequence = entry.sequence;
+				newestSlot = slot;
+			}
+
+			if (journal->slots [entry.key] == SLOT_NONE || (int8_t) (entry.sequence - keySequences [entry.key]) > 0)
+			{
+				journal->slots [entry.key] = slot;
+				journal->values [entry.key] = entry.value;
+				keySequences [entry.key] = entry.sequence;
+			}
+		}
+	}
+
+	// Continue from the newest entry
+	if (entryFound)
+	{
+		journal->head = (newestSlot + 1) % SLOT_COUNT;
+		journal->sequence = newestSequence + 1;
+	}
+
+	return true;
+}
+
+uint32_t mc24lc32JournalRead (mc24lc32Journal_t* journal, uint8_t key)
+{
+	if (key >= journal->keyCount)
+		return 0;
+
+	return journal->values [key];
+}
+
+float mc24lc32JournalReadFloat (mc24lc32Journal_t* journal, uint8_t key)
+{
+	if (key >= journal->keyCount)
+		return 0.0f;
+
+	float value;
+	memcpy (&value, &journal->values [key], sizeof (value));
+	return value;
+}
+
+bool mc24lc32JournalWrite (mc24lc32Journal_t* journal, uint8_t key, uint32_t value)
+{
+	// Keys outside of the journal would be ignored when scanned, so would be lost.
+	if (key >= journal->keyCount)
+		return false;
+
+	// If the value is unchanged, don't waste a write.
+	if (journal->slots [key] != SLOT_NONE && journal->values [key] == value)
+		return true;
+
+	// Entries to append, the update followed by any live entries being carried forward.
+	mc24lc32JournalEntry_t entries [MC24LC32_JOURNAL_KEY_COUNT + 1];
+	uint8_t entryCount = 0;
+
+	entries [entryCount++] = (mc24lc32JournalEntry_t) { .key = key, .value = value };
+
+	// Garbage collection: carry forward the live entries of any slot that will be within the gap once the head has moved
+	// past the appended entries. Note each carried entry moves the head, so the range grows with each.
+	for (uint8_t offset = 0; offset < entryCount + GAP_SLOT_COUNT; ++offset)
+	{
+		uint8_t slot = (journal->head + offset) % SLOT_COUNT;
+		for (uint8_t liveKey = 0; liveKey < journal->keyCount; ++liveKey)
+		{
+			// The previous entry of the key being written is no longer live.
+			if (liveKey != key && journal->slots [liveKey] == slot)
+				entries [entryCount++] = (mc24lc32JournalEntry_t) { .key = liveKey, .value = journal->values [liveKey] };
+		}
+	}
+
+	// Append the entries, one page write for each page they span.
+	uint8_t slot = journal->head;
+	uint8_t index = 0;
+	while (index < entryCount)
+	{
+		uint8_t pageEntryCount = PAGE_ENTRY_COUNT - slot % PAGE_ENTRY_COUNT;
+		if (pageEntryCount > entryCount - index)
+			pageEntryCount = entryCount - index;
+
+		uint8_t buffer [MC24LC32_PAGE_SIZE];
+		for (uint8_t pageIndex = 0; pageIndex < pageEntryCount; ++pageIndex)
+		{
+			mc24lc32JournalEntry_t* entry = &entries [index + pageIndex];
+			entry->sequence = journal->sequence + index + pageIndex;
+			entry->check = mc24lc32JournalCheck (entry);
+			memcpy (buffer + pageIndex * ENTRY_SIZE, entry, ENTRY_SIZE);
+		}
+
+		if (!mc24lc32PageWrite (journal->eeprom, MC24LC32_JOURNAL_ADDRESS + slot * ENTRY_SIZE, buffer,
+			pageEntryCount * ENTRY_SIZE))
+			return false;
+
+		slot = (slot + pageEntryCount) % SLOT_COUNT;
+		index += pageEntryCount;
+	}
+
+	// Update the index to the new locations.
+	for (index = 0; index < entryCount; ++index)
+		journal->slots [entries [index].key] = (journal->head + index) % SLOT_COUNT;
+
+	journal->values [key] = value;
+	journal->head = slot;
+	journal->sequence += entryCount;
+	return true;
+}
+
+bool mc24lc32JournalWriteFloat (mc24lc32Journal_t* journal, uint8_t key, float value)
+{
+	uint32_t word;
+	memcpy (&word, &value, sizeof (word));
+	return mc24lc32JournalWrite (journal, key, word);
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+#ifndef MC24LC32_JOURNAL_H
+#define MC24LC32_JOURNAL_H
+
+// MC24LC32 Journal -----------------------------------------------------------------------------------------------------------
+//
+// Author: agent
+// Date Created: 2026.10.17
+//
+// Description: Wear-leveled store for frequently updated values (ex. odometer, energy used, fault counters), using the
+//   journal area of a 24LC32 EEPROM. Rather than overwriting a fixed address, each update is appended to a circular log of
+//   small entries, spreading the wear over the entire area. The latest value of each key is held in RAM, such that reads
+//   never access the device.
+//
+//   Space is reclaimed by a compacting garbage collector that runs ahead of the log's head: any live entry (the latest entry
+//   of its key) that the head is about to reach is copied to the head as part of the same write. As the old copy is only
+//   overwritten after the new copy is written, an interrupted write can only lose the update being written. Typically
+//   each update costs a single page write.
+
+// Includes -------------------------------------------------------------------------------------------------------------------
+
+// Includes
+#include "peripherals/mc24lc32.h"
+
+// Constants ------------------------------------------------------------------------------------------------------------------
+
+/// @brief The maximum number of keys (values) a journal can store.
+#define MC24LC32_JOURNAL_KEY_COUNT 16
+
+// Datatypes ------------------------------------------------------------------------------------------------------------------
+
+typedef struct
+{
+	/// @brief The EEPROM whose journal area to use.
+	mc24lc32_t* eeprom;
+
+	/// @brief The number of keys to store, keys are in the range [0, keyCount). Must not exceed
+	/// @c MC24LC32_JOURNAL_KEY_COUNT .
+	uint8_t keyCount;
+
+	/// @brief The value of each key that has never been written. Use @c NULL to default all keys to 0.
+	const uint32_t* defaults;
+} mc24lc32JournalConfig_t;
+
+/// @brief Wear-leveled log of frequently updated values.
+typedef struct
+{
+	/// @brief The EEPROM whose journal area is used.
+	mc24lc32_t* eeprom;
+
+	/// @brief The number of keys stored.
+	uint8_t keyCount;
+
+	/// @brief The slot the next entry will be written to.
+	uint8_t head;
+
+	/// @brief The sequence number of the next entry.
+	uint8_t sequence;
+
+	/// @brief The latest value of each key.
+	uint32_t values [MC24LC32_JOURNAL_KEY_COUNT];
+
+	/// @brief The slot containing the latest entry of each key.
+	uint8_t slots [MC24LC32_JOURNAL_KEY_COUNT];
+} mc24lc32Journal_t;
+
+// Functions ------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Initializes the journal using the specified configuration. The journal area is scanned to recover the latest value
+ * of each key.
+ * @param journal The journal to initialize.
+ * @param config The configuration to use.
+ * @return True if successful, false otherwise.
+ */
+bool mc24lc32JournalInit (mc24lc32Journal_t* journal, mc24lc32JournalConfig_t* config);
+
+/**
+ * @brief Gets the latest value of a key. This does not access the device.
+ * @param journal The journal to read from.
+ * @param key The key to read.
+ * @return The value of the key, 0 if the key is not in the journal.
+ */
+uint32_t mc24lc32JournalRead (mc24lc32Journal_t* journal, uint8_t key);
+
+/**
+ * @brief Gets the latest value of a key, interpreted as a float. This does not access the device.
+ * @param journal The journal to read from.
+ * @param key The key to read.
+ * @return The value of the key, 0 if the key is not in the journal.
+ */
+float mc24lc32JournalReadFloat (mc24lc32Journal_t* journal, uint8_t key);
+
+/**
+ * @brief Appends an update of a key to the journal. If the value is unchanged, nothing is written.
+ * @param journal The journal to write to.
+ * @param key The key to write.
+ * @param value The value to write.
+ * @return True if successful, false otherwise. Keys not in the journal are rejected.
+ */
+bool mc24lc32JournalWrite (mc24lc32Journal_t* journal, uint8_t key, uint32_t value);
+
+/**
+ * @brief Appends an update of a key to the journal, the value being a float. If the value is unchanged, nothing is written.
+ * @param journal The journal to write to.
+ * @param key The key to write.
+ * @param value The value to write.
+ * @return True if successful, false otherwise. Keys not in the journal are rejected.
+ */
+bool mc24lc32JournalWriteFloat (mc24lc32Journal_t* journal, uint8_t key, float value);
+
+#endif // MC24LC32_JOURNAL_H
\ No newline at end of file
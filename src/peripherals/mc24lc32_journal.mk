@@ -0,0 +1,5 @@
+# Include the module's common dependencies
+include common/src/peripherals/mc24lc32.mk
+
+# Add the module's source file to the compilation
+CSRC += common/src/peripherals/mc24lc32_journal.c
\ No newline at end of file
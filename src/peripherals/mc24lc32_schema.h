@@ -0,0 +1,194 @@
+#ifndef MC24LC32_SCHEMA_H
+#define MC24LC32_SCHEMA_H
+
+// MC24LC32 Parameter Schema --------------------------------------------------------------------------------------------------
+//
+// Author: agent
+// Date Created: 2026.10.17
+//
+// Description: Macros for generating typed accessors of the parameters stored in a 24LC32's cache, from a single X-macro
+//   list. Getters compile down to a direct load from the cache, setters range-check the value and mark the modified page
+//   as dirty. The schema also generates a table of the parameters (for tooling) and functions for loading the default
+//   values and migrating the memory from a previous layout version.
+//
+//   The parameter list is a macro taking an X-macro and a prefix, invoking the X-macro once per parameter as
+//   X (prefix, name, type, address, default, min, max, version). The name should be in PascalCase, the version is the
+//   layout version the parameter was introduced in. The type must be one of uint8_t, uint16_t, uint32_t, int8_t, int16_t,
+//   int32_t or float, range checks being performed in that type. For example (line continuations omitted):
+//
+//     #define EEPROM_PARAMETERS(X, p)
+//       X (p, TorqueLimit,		float,		0x0010,	21.0f,	0.0f,	21.0f,	1)
+//       X (p, RegenEnabled,	uint8_t,	0x0014,	1,		0,		1,		1)
+//       X (p, PedalDeadzone,	float,		0x0018,	0.05f,	0.0f,	0.25f,	2)
+//
+//     // In a header:
+//     MC24LC32_SCHEMA_DECLARE (eeprom, EEPROM_PARAMETERS)
+//
+//     // In exactly one source file, storing the layout version at 0x000C:
+//     MC24LC32_SCHEMA_DEFINE (eeprom, EEPROM_PARAMETERS, 0x000C, 2)
+//
+//   Which generates eepromGetTorqueLimit, eepromSetTorqueLimit, etc., along with eepromParameters, eepromParameterCount,
+//   eepromLoadDefaults and eepromMigrate.
+//
+//   Migration only resets parameters introduced after the stored layout version, or whose stored value is out of range, so
+//   the address of a parameter must never change between layout versions (a parameter may only be moved by introducing it
+//   under a new name and version). If the stored layout version is blank (never written) or newer than the current version
+//   (a downgrade), nothing about the layout can be assumed, so every parameter is reset to its default.
+//
+//   This module is header-only, it only requires the mc24lc32 module.
+
+// Includes -------------------------------------------------------------------------------------------------------------------
+
+// Includes
+#include "peripherals/mc24lc32.h"
+
+// C Standard Library
+#include <string.h>
+
+// Datatypes ------------------------------------------------------------------------------------------------------------------
+
+/// @brief Description of a parameter of a schema.
+typedef struct
+{
+	/// @brief The name of the parameter.
+	const char* name;
+
+	/// @brief The C type of the parameter, as a string.
+	const char* type;
+
+	/// @brief The address of the parameter in the cache.
+	uint16_t address;
+
+	/// @brief The size of the parameter, in bytes.
+	uint8_t size;
+
+	/// @brief The layout version the parameter was introduced in.
+	uint16_t version;
+} mc24lc32Parameter_t;
+
+// Macros ---------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Declares the accessors, table and functions of a schema. Should be used in a header.
+ * @param prefix The prefix of the generated identifiers.
+ * @param parameters The parameter list macro.
+ */
+#define MC24LC32_SCHEMA_DECLARE(prefix, parameters)																	\
+	parameters (MC24LC32_SCHEMA_ACCESSORS, prefix)																	\
+																													\
+	/** @brief Table of the schema's parameters. */																\
+	extern const mc24lc32Parameter_t prefix##Parameters [];														\
+																													\
+	/** @brief Number of elements in the parameter table. */														\
+	extern const uint16_t prefix##ParameterCount;																	\
+																													\
+	/** @brief Writes the default value of every parameter and the current layout version to the cache. */			\
+	void prefix##LoadDefaults (mc24lc32_t* eeprom);																	\
+																													\
+	/** @brief Writes the default value of every parameter introduced after the stored layout version, or whose value is	\
+	 * out of range, then stores the current layout version. If the stored layout version is blank or newer than	\
+	 * the current version, every parameter is reset instead. Returns the previously stored layout version. */		\
+	uint16_t prefix##Migrate (mc24lc32_t* eeprom);
+
+/**
+ * @brief Defines the table and functions of a schema. Should be used in exactly one source file.
+ * @param prefix The prefix of the generated identifiers.
+ * @param parameters The parameter list macro.
+ * @param versionAddress The address of the layout version (a @c uint16_t ) in the cache.
+ * @param currentVersion The current layout version.
+ */
+#define MC24LC32_SCHEMA_DEFINE(prefix, parameters, versionAddress, currentVersion)									\
+	const mc24lc32Parameter_t prefix##Parameters [] =																\
+	{																												\
+		parameters (MC24LC32_SCHEMA_ENTRY, prefix)																	\
+	};																												\
+																													\
+	const uint16_t prefix##ParameterCount = sizeof (prefix##Parameters) / sizeof (mc24lc32Parameter_t);			\
+																													\
+	void prefix##LoadDefaults (mc24lc32_t* eeprom)																	\
+	{																												\
+		parameters (MC24LC32_SCHEMA_DEFAULT, prefix)																\
+		MC24LC32_SCHEMA_STORE (eeprom, uint16_t, versionAddress, currentVersion)									\
+	}																												\
+																													\
+	uint16_t prefix##Migrate (mc24lc32_t* eeprom)																	\
+	{																												\
+		uint16_t storedVersion;																						\
+		memcpy (&storedVersion, eeprom->cache + (versionAddress), sizeof (uint16_t));								\
+		if (storedVersion == 0xFFFF || storedVersion > (currentVersion))											\
+		{																											\
+			prefix##LoadDefaults (eeprom);																			\
+			return storedVersion;																					\
+		}																											\
+		parameters (MC24LC32_SCHEMA_MIGRATE, prefix)																\
+		MC24LC32_SCHEMA_STORE (eeprom, uint16_t, versionAddress, currentVersion)									\
+		return storedVersion;																						\
+	}
+
+// Range Checks ---------------------------------------------------------------------------------------------------------------
+
+// Note: Comparisons are performed by a function of each type, rather than directly in the macros, as the bounds being
+// function parameters avoids type-limit warnings for unsigned parameters with a minimum of 0. NaN values are out of range.
+
+/// @brief Generates the range check function of a type.
+#define MC24LC32_SCHEMA_RANGE_CHECK(type)																			\
+	static inline bool mc24lc32SchemaInRange_##type (type value, type min, type max)								\
+	{																												\
+		return value >= min && value <= max;																		\
+	}
+
+MC24LC32_SCHEMA_RANGE_CHECK (uint8_t)
+MC24LC32_SCHEMA_RANGE_CHECK (uint16_t)
+MC24LC32_SCHEMA_RANGE_CHECK (uint32_t)
+MC24LC32_SCHEMA_RANGE_CHECK (int8_t)
+MC24LC32_SCHEMA_RANGE_CHECK (int16_t)
+MC24LC32_SCHEMA_RANGE_CHECK (int32_t)
+MC24LC32_SCHEMA_RANGE_CHECK (float)
+
+// Parameter Macros -----------------------------------------------------------------------------------------------------------
+
+/// @brief Checks whether a value is within a parameter's range, comparing in the parameter's type.
+#define MC24LC32_SCHEMA_IN_RANGE(type, value, min, max)																\
+	mc24lc32SchemaInRange_##type ((value), (min), (max))
+
+/// @brief Writes a value to the cache, marking it as dirty. The address is checked at compile-time, so the write cannot
+/// fail.
+#define MC24LC32_SCHEMA_STORE(eeprom, type, address, value)															\
+	{																												\
+		type storeValue = (type) (value);																			\
+		mc24lc32CacheWrite ((eeprom), (address), &storeValue, sizeof (type));										\
+	}
+
+/// @brief Generates the getter and setter of a parameter, along with a compile-time check of its address.
+#define MC24LC32_SCHEMA_ACCESSORS(prefix, name, type, address, defaultValue, min, max, version)						\
+	typedef char prefix##name##IsInCache [(address) + sizeof (type) <= MC24LC32_DATA_SIZE ? 1 : -1];				\
+																													\
+	static inline type prefix##Get##name (const mc24lc32_t* eeprom)												\
+	{																												\
+		type value;																									\
+		memcpy (&value, eeprom->cache + (address), sizeof (type));													\
+		return value;																								\
+	}																												\
+																													\
+	static inline bool prefix##Set##name (mc24lc32_t* eeprom, type value)											\
+	{																												\
+		if (!MC24LC32_SCHEMA_IN_RANGE (type, value, min, max))														\
+			return false;																							\
+		MC24LC32_SCHEMA_STORE (eeprom, type, address, value)														\
+		return true;																								\
+	}
+
+/// @brief Generates the parameter table entry of a parameter.
+#define MC24LC32_SCHEMA_ENTRY(prefix, name, type, address, defaultValue, min, max, version)							\
+	{ #name, #type, (address), sizeof (type), (version) },
+
+/// @brief Writes the default value of a parameter.
+#define MC24LC32_SCHEMA_DEFAULT(prefix, name, type, address, defaultValue, min, max, version)						\
+	MC24LC32_SCHEMA_STORE (eeprom, type, address, defaultValue)
+
+/// @brief Writes the default value of a parameter, if it is newer than the stored layout version or out of range.
+#define MC24LC32_SCHEMA_MIGRATE(prefix, name, type, address, defaultValue, min, max, version)						\
+	if (storedVersion < (version) || !MC24LC32_SCHEMA_IN_RANGE (type, prefix##Get##name (eeprom), min, max))		\
+		MC24LC32_SCHEMA_STORE (eeprom, type, address, defaultValue)
+
+#endif // MC24LC32_SCHEMA_H
\ No newline at end of file
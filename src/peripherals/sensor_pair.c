@@ -0,0 +1,112 @@
+// Header
+#include "sensor_pair.h"
+
+// Function Prototypes --------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Evaluates the plausibility of the pair. Must be called from a critical section.
+ * @param pair The pair to evaluate.
+ */
+void sensorPairEvaluateLocked (sensorPair_t* pair);
+
+// Functions ------------------------------------------------------------------------------------------------------------------
+
+bool sensorPairInit (sensorPair_t* pair, sensorPairConfig_t* config)
+{
+	// Store the configuration
+	pair->config = config;
+
+	// Validate the configuration
+	if (config->sensorA == NULL || config->sensorB == NULL || config->tolerance <= 0.0f || config->hysteresis < 0.0f ||
+		config->hysteresis >= config->tolerance)
+		pair->state = SENSOR_PAIR_CONFIG_INVALID;
+	else
+		pair->state = SENSOR_PAIR_IMPLAUSIBLE;
+
+	// Set values to their defaults
+	pair->value = 0.0f;
+	pair->disagreementTime = chVTGetSystemTimeX ();
+	pair->implausibleCount = 0;
+
+	return pair->state != SENSOR_PAIR_CONFIG_INVALID;
+}
+
+void sensorPairUpdateA (void* object, adcsample_t sample)
+{
+	sensorPair_t* pair = (sensorPair_t*) object;
+
+	if (pair->state == SENSOR_PAIR_CONFIG_INVALID)
+		return;
+
+	linearSensorUpdate (pair->config->sensorA, sample);
+}
+
+void sensorPairUpdateB (void* object, adcsample_t sample)
+{
+	sensorPair_t* pair = (sensorPair_t*) object;
+
+	if (pair->state == SENSOR_PAIR_CONFIG_INVALID)
+		return;
+
+	linearSensorUpdate (pair->config->sensorB, sample);
+	sensorPairEvaluate (pair);
+}
+
+void sensorPairEvaluate (sensorPair_t* pair)
+{
+	// If the config is invalid, don't check anything else.
+	if (pair->state == SENSOR_PAIR_CONFIG_INVALID)
+		return;
+
+	// The sensors and the state may be written by the ADC's interrupt, which may also be the caller, so the status is
+	// restored rather than unlocked.
+	syssts_t status = osalSysGetStatusAndLockX ();
+	sensorPairEvaluateLocked (pair);
+	osalSysRestoreStatusX (status);
+}
+
+void sensorPairEvaluateLocked (sensorPair_t* pair)
+{
+	linearSensor_t* sensorA = pair->config->sensorA;
+	linearSensor_t* sensorB = pair->config->sensorB;
+
+	// The sensors agree if both are valid and their difference is within the tolerance. Once the pair is implausible, the
+	// difference must also be within the hysteresis. A pending disagreement recovers at the tolerance itself, as the pair
+	// is still in use.
+	bool agree = false;
+	if (sensorA->state == LINEAR_SENSOR_VALID && sensorB->state == LINEAR_SENSOR_VALID)
+	{
+		float difference = sensorA->value - sensorB->value;
+		if (difference < 0)
+			difference = -difference;
+
+		float threshold = pair->config->tolerance;
+		if (pair->state == SENSOR_PAIR_IMPLAUSIBLE)
+			threshold -= pair->config->hysteresis;
+
+		agree = difference <= threshold;
+	}
+
+	if (agree)
+	{
+		pair->state = SENSOR_PAIR_PLAUSIBLE;
+		pair->value = (sensorA->value + sensorB->value) * 0.5f;
+		return;
+	}
+
+	// Start timing the disagreement. The value holds the last plausible one.
+	systime_t timeCurrent = chVTGetSystemTimeX ();
+	if (pair->state == SENSOR_PAIR_PLAUSIBLE)
+	{
+		pair->state = SENSOR_PAIR_PENDING;
+		pair->disagreementTime = timeCurrent;
+	}
+
+	// If the disagreement persists for longer than the window, the pair is implausible.
+	if (pair->state == SENSOR_PAIR_PENDING && chTimeDiffX (pair->disagreementTime, timeCurrent) > pair->config->window)
+	{
+		pair->state = SENSOR_PAIR_IMPLAUSIBLE;
+		pair->value = 0.0f;
+		++pair->implausibleCount;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#ifndef SENSOR_PAIR_H
+#define SENSOR_PAIR_H
+
+// Redundant Sensor Pair ------------------------------------------------------------------------------------------------------
+//
+// Author: agent
+// Date Created: 2026.10.17
+//
+// Description: Object checking the plausibility of two redundant linear sensors measuring the same quantity (ex. APPS 1 /
+//   APPS 2, front / rear brake pressure). The sensors' values must be in the same units, meaning their configurations map
+//   their sample ranges onto the same value range (ex. 0 to 100% pedal travel).
+//
+//   The pair is plausible while both sensors are valid and their values agree within a tolerance. Once they disagree, the
+//   pair remains usable (holding the last plausible value) until the disagreement has persisted for longer than a window,
+//   after which the pair is implausible (ex. the 100 ms rule of the accelerator pedal position sensors). Once implausible,
+//   the values must agree within the tolerance less a hysteresis to become plausible again, preventing the pair from
+//   toggling while the difference sits at the tolerance.
+//
+//   The pair is updated in place of its sensors, such that the check runs in the same context as the samples (ex. the ADC's
+//   interrupt in continuous mode), without an additional thread. Sensor A must be updated before sensor B, the pair being
+//   evaluated after each update of B (ex. A preceding B in the analog_t's sequence). The evaluation runs in a critical
+//   section, so the pair may be read or evaluated from a thread while the ADC's interrupt updates it.
+
+// Includes -------------------------------------------------------------------------------------------------------------------
+
+#include "peripherals/linear_sensor.h"
+
+// Datatypes ------------------------------------------------------------------------------------------------------------------
+
+typedef struct
+{
+	/// @brief The first sensor of the pair, updated by @c sensorPairUpdateA .
+	linearSensor_t* sensorA;
+
+	/// @brief The second sensor of the pair, updated by @c sensorPairUpdateB .
+	linearSensor_t* sensorB;
+
+	/// @brief The maximum difference between the sensors' values for them to agree, in the sensors' value units.
+	float tolerance;
+
+	/// @brief Once the pair is implausible, the amount the difference must fall below the tolerance by to be plausible
+	/// again. Must be less than the tolerance.
+	float hysteresis;
+
+	/// @brief The duration a disagreement may persist for before the pair is implausible.
+	sysinterval_t window;
+} sensorPairConfig_t;
+
+typedef enum
+{
+	/// @brief Indicates the pair's configuration is invalid.
+	SENSOR_PAIR_CONFIG_INVALID = 0,
+
+	/// @brief Indicates the sensors have disagreed for longer than the window. The value must not be used.
+	SENSOR_PAIR_IMPLAUSIBLE = 1,
+
+	/// @brief Indicates the sensors disagree, but not yet for longer than the window. The value is the last plausible one.
+	SENSOR_PAIR_PENDING = 2,
+
+	/// @brief Indicates the sensors agree.
+	SENSOR_PAIR_PLAUSIBLE = 3
+} sensorPairState_t;
+
+typedef struct
+{
+	sensorPairState_t	state;
+	sensorPairConfig_t*	config;
+
+	/// @brief The mean of the sensors' values, as of the last time the pair was plausible. 0 while implausible.
+	float				value;
+
+	/// @brief The time the current disagreement started at.
+	systime_t			disagreementTime;
+
+	/// @brief The number of times the pair became implausible.
+	uint32_t			implausibleCount;
+} sensorPair_t;
+
+// Functions ------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Initializes the pair using the specified configuration. The pair starts implausible, until the sensors first agree.
+ * @param pair The pair to initialize.
+ * @param config The configuration to use.
+ * @return True if successful, false otherwise.
+ */
+bool sensorPairInit (sensorPair_t* pair, sensorPairConfig_t* config);
+
+/**
+ * @brief Updates the first sensor of the pair.
+ * @note This function uses a @c void* for the object reference as to make the signature usable by callbacks.
+ * @param object The pair to update (must be a @c sensorPair_t* ).
+ * @param sample The read sample of the first sensor.
+ */
+void sensorPairUpdateA (void* object, adcsample_t sample);
+
+/**
+ * @brief Updates the second sensor of the pair, then evaluates the pair.
+ * @note This function uses a @c void* for the object reference as to make the signature usable by callbacks.
+ * @param object The pair to update (must be a @c sensorPair_t* ).
+ * @param sample The read sample of the second sensor.
+ */
+void sensorPairUpdateB (void* object, adcsample_t sample);
+
+/**
+ * @brief Evaluates the plausibility of the pair, using the sensors' current values. Only needed if the sensors are updated
+ * externally, rather than through the pair. Callable from any context, the state being updated in a critical section.
+ * @param pair The pair to evaluate.
+ */
+void sensorPairEvaluate (sensorPair_t* pair);
+
+#endif // SENSOR_PAIR_H
\ No newline at end of file
@@ -0,0 +1,5 @@
+# Include the module's common dependencies
+include common/src/peripherals/linear_sensor.mk
+
+# Add the module's source file to the compilation
+CSRC += common/src/peripherals/sensor_pair.c
\ No newline at end of file
@@ -0,0 +1,140 @@
+// Header
+#include "table_sensor.h"
+
+// Function Prototypes --------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Finds the segment of a non-uniform table containing a sample. The sample must be within the table.
+ * @return The index of the first point of the segment.
+ */
+uint16_t tableSensorFindSegment (tableSensor_t* sensor, adcsample_t sample);
+
+// Functions ------------------------------------------------------------------------------------------------------------------
+
+bool tableSensorInit (tableSensor_t* sensor, const tableSensorConfig_t* config)
+{
+	// Store the configuration
+	sensor->config = config;
+	sensor->state = TABLE_SENSOR_CONFIG_INVALID;
+	sensor->segmentHint = 0;
+	sensor->stepInverse = 0.0f;
+
+	// Set values to their defaults
+	sensor->value = 0.0f;
+	sensor->sample = 0;
+
+	// Validate the configuration
+	if (config->values == NULL || config->pointCount < 2)
+		return false;
+
+	if (config->samples == NULL)
+	{
+		// Uniform spacing, the last point must be a valid sample.
+		uint32_t sampleMax = config->sampleMin + (uint32_t) config->sampleStep * (config->pointCount - 1);
+		if (config->sampleStep == 0 || sampleMax > UINT16_MAX)
+			return false;
+
+		sensor->sampleMin = config->sampleMin;
+		sensor->sampleMax = sampleMax;
+		sensor->stepInverse = 1.0f / config->sampleStep;
+	}
+	else
+	{
+		// Non-uniform spacing, the samples must be strictly increasing.
+		for (uint16_t index = 1; index < config->pointCount; ++index)
+			if (config->samples [index] <= config->samples [index - 1])
+				return false;
+
+		sensor->sampleMin = config->samples [0];
+		sensor->sampleMax = config->samples [config->pointCount - 1];
+	}
+
+	sensor->state = TABLE_SENSOR_VALUE_INVALID;
+	return true;
+}
+
+void tableSensorUpdate (void* object, adcsample_t sample)
+{
+	tableSensor_t* sensor = (tableSensor_t*) object;
+	const tableSensorConfig_t* config = sensor->config;
+
+	// Store the sample.
+	sensor->sample = sample;
+
+	// If the config is invalid, don't check anything else.
+	if (sensor->state == TABLE_SENSOR_CONFIG_INVALID)
+		return;
+
+	// Check the sample is in the table
+	if (sample < sensor->sampleMin || sample > sensor->sampleMax)
+	{
+		sensor->state = TABLE_SENSOR_VALUE_INVALID;
+		sensor->value = 0;
+		return;
+	}
+
+	sensor->state = TABLE_SENSOR_VALID;
+
+	uint16_t segment;
+	float fraction;
+	if (config->samples == NULL)
+	{
+		// Uniform spacing, index the segment directly. The last point belongs to the last segment.
+		uint16_t offset = sample - sensor->sampleMin;
+		segment = offset / config->sampleStep;
+		if (segment == config->pointCount - 1)
+			--segment;
+
+		fraction = (offset - segment * config->sampleStep) * sensor->stepInverse;
+	}
+	else
+	{
+		// Non-uniform spacing, search for the segment.
+		segment = tableSensorFindSegment (sensor, sample);
+		fraction = (float) (sample - config->samples [segment]) /
+			(config->samples [segment + 1] - config->samples [segment]);
+	}
+
+	// Interpolate between the points of the segment.
+	float valueA = config->values [segment];
+	float valueB = config->values [segment + 1];
+	sensor->value = valueA + (valueB - valueA) * fraction;
+}
+
+uint16_t tableSensorFindSegment (tableSensor_t* sensor, adcsample_t sample)
+{
+	const adcsample_t* samples = sensor->config->samples;
+	uint16_t segmentCount = sensor->config->pointCount - 1;
+
+	// Check the last segment and its neighbours first, as samples typically change slowly.
+	uint16_t hint = sensor->segmentHint;
+	if (sample >= samples [hint] && sample <= samples [hint + 1])
+		return hint;
+
+	if (hint + 1 < segmentCount && sample >= samples [hint + 1] && sample <= samples [hint + 2])
+	{
+		sensor->segmentHint = hint + 1;
+		return hint + 1;
+	}
+
+	if (hint > 0 && sample >= samples [hint - 1] && sample <= samples [hint])
+	{
+		sensor->segmentHint = hint - 1;
+		return hint - 1;
+	}
+
+	// Binary search for the last point not greater than the sample, the sample is known to be within the table.
+	uint16_t low = 0;
+	uint16_t high = segmentCount;
+	while (high - low > 1)
+	{
+		uint16_t middle = low + (high - low) / 2;
+		if (samples [middle] <= sample)
+			low = middle;
+		else
+			high = middle;
+	}
+
+	sensor->segmentHint = low;
+	return low;
+}
\ No newline at end of file
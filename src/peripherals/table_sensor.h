@@ -0,0 +1,93 @@
+#ifndef TABLE_SENSOR_H
+#define TABLE_SENSOR_H
+
+// Table Sensor ---------------------------------------------------------------------------------------------------------------
+//
+// Author: agent
+// Date Created: 2026.10.17
+//
+// Description: Object representing a sensor with a non-linear transfer function, defined by a calibration table (ex.
+//   thermistors, ride-height potentiometers). The value is linearly interpolated between the two points of the table
+//   surrounding the sample. Like the linear_sensor.h object, this is mainly designed to be used with the analog_t object.
+//
+//   The table's points are either uniformly spaced, in which case the segment of a sample is found by indexing, or
+//   non-uniformly spaced, in which case the segment is found by binary search. As the samples of a sensor typically change
+//   slowly, the last segment is remembered and checked (along with its neighbours) before searching. The tables, and the
+//   configuration, are constant, so may be placed in flash.
+
+// Includes -------------------------------------------------------------------------------------------------------------------
+
+#include "hal.h"
+
+// Datatypes ------------------------------------------------------------------------------------------------------------------
+
+typedef struct
+{
+	/// @brief The sample of each point of the table, strictly increasing. Use @c NULL for uniformly spaced points, see
+	/// @c sampleMin and @c sampleStep .
+	const adcsample_t* samples;
+
+	/// @brief The value of each point of the table.
+	const float* values;
+
+	/// @brief The number of points in the table, at least 2.
+	uint16_t pointCount;
+
+	/// @brief Uniformly spaced points only, the sample of the first point.
+	adcsample_t sampleMin;
+
+	/// @brief Uniformly spaced points only, the difference between the samples of consecutive points.
+	adcsample_t sampleStep;
+} tableSensorConfig_t;
+
+typedef enum
+{
+	/// @brief Indicates the sensor's configuration is invalid.
+	TABLE_SENSOR_CONFIG_INVALID = 0,
+
+	/// @brief Indicates the sensor's last read value was invalid (outside the table).
+	TABLE_SENSOR_VALUE_INVALID = 2,
+
+	/// @brief Indicates the sensor's reading is valid.
+	TABLE_SENSOR_VALID = 3
+} tableSensorState_t;
+
+typedef struct
+{
+	tableSensorState_t			state;
+	const tableSensorConfig_t*	config;
+	adcsample_t					sample;
+	float						value;
+
+	/// @brief The sample of the first point of the table.
+	adcsample_t					sampleMin;
+
+	/// @brief The sample of the last point of the table.
+	adcsample_t					sampleMax;
+
+	/// @brief Uniformly spaced points only, the reciprocal of the step, such that interpolation needs no division.
+	float						stepInverse;
+
+	/// @brief Non-uniformly spaced points only, the index of the first point of the last segment.
+	uint16_t					segmentHint;
+} tableSensor_t;
+
+// Functions ------------------------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Initializes the sensor using the specified configuration.
+ * @param sensor The sensor to initialize.
+ * @param config The configuration to use.
+ * @return True if successful, false otherwise.
+ */
+bool tableSensorInit (tableSensor_t* sensor, const tableSensorConfig_t* config);
+
+/**
+ * @brief Updates the value of the sensor.
+ * @note This function uses a @c void* for the object reference as to make the signature usable by callbacks.
+ * @param object The sensor to update (must be a @c tableSensor_t* ).
+ * @param sample The read sample.
+ */
+void tableSensorUpdate (void* object, adcsample_t sample);
+
+#endif // TABLE_SENSOR_H
\ No newline at end of file
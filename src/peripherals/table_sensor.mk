@@ -0,0 +1,2 @@
+# Add the module's source file to the compilation
+CSRC += common/src/peripherals/table_sensor.c
\ No newline at end of file